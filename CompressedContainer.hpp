@@ -0,0 +1,420 @@
+//CompressedContainer.hpp
+#pragma once
+#include "MyContainer.hpp"
+#include <algorithm>
+#include <bit>        // For std::bit_width
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Container {
+    // --- CompressedContainer (compressed in-memory storage for integers)
+    // Holds integers in blocks of block_size values. Each full block is bit-packed after one of two
+    // transforms, whichever needs fewer bits per value:
+    //   frame of reference - value minus the block minimum (clustered values, low-cardinality codes);
+    //   delta              - difference to the previous value minus the smallest difference
+    //                        (monotone or slowly changing values such as IDs and timestamps).
+    // A block costs a small header plus block_size * bits / 8 bytes; the newest, not yet full block is
+    // kept uncompressed. Values are decoded on the fly: frame-of-reference values are found in O(1) from
+    // their index, delta values in O(position in block), or O(1) when the iterator's previous value is
+    // the neighbouring one, which makes insertion and reverse traversal decode sequentially.
+    // All six traversal orders are supported through the same policies as MyContainer. The sorted
+    // orders need the sorted permutation (one size_t per element), built on first use as in MyContainer.
+    // Iterators yield values (not references), so they model std::forward_iterator but are input
+    // iterators for legacy algorithms.
+    template <typename T>
+    class CompressedContainer {
+        static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                      "CompressedContainer stores integer types only.");
+
+    public:
+        static constexpr size_t block_size = 128;
+
+    private:
+        using U = std::make_unsigned_t<T>;
+        using S = std::make_signed_t<U>;
+
+        struct Block {
+            U base;                   // Minimum (frame of reference) or first value (delta)
+            U min_delta;              // Smallest difference between neighbours (delta only)
+            size_t first_word;        // Start of the block's bits in 'packed'
+            std::uint8_t bits;        // Bits per packed value (0 when they are all equal)
+            bool delta;
+        };
+
+        std::vector<Block> blocks;
+        std::vector<std::uint64_t> packed;
+        std::vector<T> tail;  // The last, incomplete block, uncompressed.
+
+        mutable std::shared_ptr<const std::vector<size_t>> sorted_cache;
+        mutable std::mutex cache_mutex;
+
+        void set_sorted_cache(std::shared_ptr<const std::vector<size_t>> sorted) {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            sorted_cache = std::move(sorted);
+        }
+
+        std::uint64_t read_bits(const Block& block, size_t position) const noexcept {
+            if (block.bits == 0) {
+                return 0;
+            }
+            const size_t bit = position * block.bits;
+            const size_t word = block.first_word + bit / 64;
+            const unsigned shift = bit % 64;
+            std::uint64_t value = packed[word] >> shift;
+            if (shift + block.bits > 64) {
+                value |= packed[word + 1] << (64 - shift);
+            }
+            return block.bits == 64 ? value : value & ((std::uint64_t{1} << block.bits) - 1);
+        }
+
+        // Compresses the full 'tail' into a new block.
+        void seal_tail() {
+            U minimum = static_cast<U>(*std::min_element(tail.begin(), tail.end()));
+            U max_offset = 0;
+            for (T value : tail) {
+                max_offset = std::max<U>(max_offset, static_cast<U>(static_cast<U>(value) - minimum));
+            }
+            U min_delta = static_cast<U>(static_cast<U>(tail[1]) - static_cast<U>(tail[0]));
+            for (size_t i = 1; i < tail.size(); ++i) {
+                U d = static_cast<U>(static_cast<U>(tail[i]) - static_cast<U>(tail[i - 1]));
+                if (static_cast<S>(d) < static_cast<S>(min_delta)) {
+                    min_delta = d;
+                }
+            }
+            U max_delta_offset = 0;
+            for (size_t i = 1; i < tail.size(); ++i) {
+                U d = static_cast<U>(static_cast<U>(tail[i]) - static_cast<U>(tail[i - 1]));
+                max_delta_offset = std::max<U>(max_delta_offset, static_cast<U>(d - min_delta));
+            }
+
+            Block block{};
+            block.delta = std::bit_width(max_delta_offset) < std::bit_width(max_offset);
+            block.base = block.delta ? static_cast<U>(tail[0]) : minimum;
+            block.min_delta = block.delta ? min_delta : 0;
+            block.bits = static_cast<std::uint8_t>(std::bit_width(block.delta ? max_delta_offset : max_offset));
+            block.first_word = packed.size();
+            packed.resize(packed.size() + (block_size * block.bits + 63) / 64, 0);
+
+            for (size_t i = 0; i < tail.size() && block.bits != 0; ++i) {
+                U stored;
+                if (block.delta) {
+                    stored = i == 0 ? U{0}
+                                    : static_cast<U>(static_cast<U>(tail[i]) - static_cast<U>(tail[i - 1]) - min_delta);
+                } else {
+                    stored = static_cast<U>(static_cast<U>(tail[i]) - minimum);
+                }
+                const size_t bit = i * block.bits;
+                const size_t word = block.first_word + bit / 64;
+                const unsigned shift = bit % 64;
+                packed[word] |= static_cast<std::uint64_t>(stored) << shift;
+                if (shift + block.bits > 64) {
+                    packed[word + 1] |= static_cast<std::uint64_t>(stored) >> (64 - shift);
+                }
+            }
+            blocks.push_back(block);
+            tail.clear();
+        }
+
+        std::vector<size_t> build_sorted_indexes() const {
+            static_assert(block_size <= 256, "Positions within a block are stored in one byte.");
+            const size_t n = size();
+            const size_t block_count = (n + block_size - 1) / block_size;
+
+            // The merge heap holds the smallest remaining (value, index) of every block.
+            struct Head {
+                T value;
+                size_t index;
+                size_t rank;  // Rank of 'index' within its block
+            };
+            auto later = [](const Head& a, const Head& b) {
+                return b.value < a.value || (!(a.value < b.value) && b.index < a.index);
+            };
+            std::vector<Head> heap;
+            heap.reserve(block_count);
+
+            // Positions of each block in (value, position) order.
+            std::vector<std::uint8_t> local(n);
+            // Delta blocks decode a value in O(1) only from a neighbouring one. Those whose sorted
+            // positions are not all neighbours (e.g. non-monotone timestamps) keep their decoded values
+            // until merged; monotone blocks step through neighbours and keep nothing.
+            std::vector<std::vector<T>> kept(block_count);
+            T decoded[block_size];
+            for (size_t b = 0; b < block_count; ++b) {
+                const size_t first = b * block_size;
+                const size_t length = std::min(block_size, n - first);
+                for (size_t i = 0; i < length; ++i) {
+                    decoded[i] = value_at(first + i, i == 0 ? npos : first + i - 1, i == 0 ? T{} : decoded[i - 1]);
+                }
+                std::uint8_t* positions = local.data() + first;
+                for (size_t i = 0; i < length; ++i) {
+                    positions[i] = static_cast<std::uint8_t>(i);
+                }
+                std::stable_sort(positions, positions + length,
+                                 [&](std::uint8_t a, std::uint8_t b) { return decoded[a] < decoded[b]; });
+                if (b < blocks.size() && blocks[b].delta) {
+                    bool neighbours = true;
+                    for (size_t i = 1; i < length && neighbours; ++i) {
+                        neighbours = positions[i] == positions[i - 1] + 1 || positions[i] + 1 == positions[i - 1];
+                    }
+                    if (!neighbours) {
+                        kept[b].assign(decoded, decoded + length);
+                    }
+                }
+                heap.push_back({decoded[positions[0]], first + positions[0], 0});
+            }
+            std::make_heap(heap.begin(), heap.end(), later);
+
+            std::vector<size_t> sorted;
+            sorted.reserve(n);
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), later);
+                Head& head = heap.back();
+                sorted.push_back(head.index);
+                const size_t b = head.index / block_size;
+                const size_t first = b * block_size;
+                if (++head.rank < std::min(block_size, n - first)) {
+                    const size_t previous = head.index;
+                    head.index = first + local[first + head.rank];
+                    head.value = kept[b].empty() ? value_at(head.index, previous, head.value)
+                                                 : kept[b][head.index - first];
+                    std::push_heap(heap.begin(), heap.end(), later);
+                } else {
+                    std::vector<T>().swap(kept[b]);
+                    heap.pop_back();
+                }
+            }
+            return sorted;
+        }
+
+    public:
+        CompressedContainer() = default;
+
+        explicit CompressedContainer(const MyContainer<T>& source) {
+            addElements(source.contents().begin(), source.contents().end());
+        }
+
+        CompressedContainer(const CompressedContainer& other)
+            : blocks(other.blocks), packed(other.packed), tail(other.tail) {
+            std::lock_guard<std::mutex> lock(other.cache_mutex);
+            sorted_cache = other.sorted_cache;
+        }
+
+        // The moved-from container is left empty.
+        CompressedContainer(CompressedContainer&& other) noexcept
+            : blocks(std::move(other.blocks)), packed(std::move(other.packed)), tail(std::move(other.tail)),
+              sorted_cache(std::move(other.sorted_cache)) {
+            other.blocks.clear();
+            other.packed.clear();
+            other.tail.clear();
+        }
+
+        CompressedContainer& operator=(const CompressedContainer& other) {
+            if (this != &other) {
+                CompressedContainer copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        CompressedContainer& operator=(CompressedContainer&& other) noexcept {
+            if (this != &other) {
+                blocks = std::move(other.blocks);
+                packed = std::move(other.packed);
+                tail = std::move(other.tail);
+                set_sorted_cache(std::move(other.sorted_cache));
+                other.blocks.clear();
+                other.packed.clear();
+                other.tail.clear();
+            }
+            return *this;
+        }
+
+        void addElement(const T& element) {
+            tail.push_back(element);
+            if (tail.size() == block_size) {
+                seal_tail();
+            }
+            set_sorted_cache(nullptr);
+        }
+
+        template <typename InputIt>
+        void addElements(InputIt first, InputIt last) {
+            for (; first != last; ++first) {
+                tail.push_back(*first);
+                if (tail.size() == block_size) {
+                    seal_tail();
+                }
+            }
+            set_sorted_cache(nullptr);
+        }
+
+        // Removes every occurrence of 'element' by decoding and re-encoding the whole container (O(n)).
+        void removeElement(const T& element) {
+            std::vector<T> values = decode();
+            auto it = std::remove(values.begin(), values.end(), element);
+            if (it == values.end()) {
+                throw std::runtime_error("Element not found in container.");
+            }
+            values.erase(it, values.end());
+            blocks.clear();
+            packed.clear();
+            tail.clear();
+            addElements(values.begin(), values.end());
+        }
+
+        size_t size() const noexcept {
+            return blocks.size() * block_size + tail.size();
+        }
+
+        // Bytes used by the compressed representation (block headers, packed bits and the open block).
+        size_t compressed_bytes() const noexcept {
+            return blocks.size() * sizeof(Block) + packed.size() * sizeof(std::uint64_t) + tail.size() * sizeof(T);
+        }
+
+        // The value at insertion index 'index'. 'hint_index'/'hint_value' may name a value already
+        // decoded (e.g. the previous one of a traversal); a neighbour in the same delta block is then
+        // decoded in O(1).
+        T value_at(size_t index, size_t hint_index = npos, T hint_value = T{}) const noexcept {
+            const size_t b = index / block_size;
+            if (b == blocks.size()) {
+                return tail[index % block_size];
+            }
+            const Block& block = blocks[b];
+            const size_t position = index % block_size;
+            if (!block.delta) {
+                return static_cast<T>(static_cast<U>(block.base + static_cast<U>(read_bits(block, position))));
+            }
+            if (hint_index != npos && hint_index / block_size == b) {
+                if (hint_index + 1 == index) {
+                    return static_cast<T>(static_cast<U>(static_cast<U>(hint_value) + block.min_delta +
+                                                         static_cast<U>(read_bits(block, position))));
+                }
+                if (index + 1 == hint_index) {
+                    return static_cast<T>(static_cast<U>(static_cast<U>(hint_value) - block.min_delta -
+                                                         static_cast<U>(read_bits(block, position + 1))));
+                }
+            }
+            U value = block.base;
+            for (size_t i = 1; i <= position; ++i) {
+                value = static_cast<U>(value + block.min_delta + static_cast<U>(read_bits(block, i)));
+            }
+            return static_cast<T>(value);
+        }
+
+        // All values in insertion order, decoded into a vector.
+        std::vector<T> decode() const {
+            std::vector<T> values;
+            values.reserve(size());
+            for (size_t i = 0; i < size(); ++i) {
+                values.push_back(value_at(i, i == 0 ? npos : i - 1, values.empty() ? T{} : values.back()));
+            }
+            return values;
+        }
+
+        // Decompresses into a regular container.
+        MyContainer<T> decompress() const {
+            std::vector<T> values = decode();
+            MyContainer<T> result;
+            result.addElements(values.begin(), values.end());
+            return result;
+        }
+
+        // Same contract as MyContainer::sorted_indexes (cached until the next modification, ties in
+        // index order). Built without decoding the whole container: each block is decoded on its own
+        // and its positions sorted into one byte each, then the sorted blocks are merged with a heap
+        // holding one value per block. Every value is decoded twice in O(1): frame-of-reference values
+        // directly, delta values from the neighbour the merge just took from the same block. Besides
+        // the permutation this needs one byte per element plus the heap, and the decoded values of
+        // delta blocks whose sorted order is not a walk between neighbours.
+        std::shared_ptr<const std::vector<size_t>> sorted_indexes() const {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (!sorted_cache) {
+                sorted_cache = std::make_shared<const std::vector<size_t>>(build_sorted_indexes());
+            }
+            return sorted_cache;
+        }
+
+        // --- OrderedIterator (the traversal policies of MyContainer over compressed values)
+        template <typename Policy>
+        class OrderedIterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using iterator_concept = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using reference = T;
+            using snapshot_type = typename Policy::snapshot_type;
+
+        private:
+            const CompressedContainer<T>* cont = nullptr;
+            snapshot_type snapshot{};
+            size_t cursor = 0;
+
+            // The last value decoded, which lets neighbouring delta values decode in O(1).
+            mutable size_t decoded_index = npos;
+            mutable T decoded_value{};
+
+        public:
+            OrderedIterator() = default;
+
+            OrderedIterator(const CompressedContainer<T>& c, snapshot_type s, size_t start)
+                : cont(&c), snapshot(std::move(s)), cursor(start) {}
+
+            T operator*() const noexcept(!checked_iterators) {
+                if constexpr (checked_iterators) {
+                    if (!Policy::dereferenceable(*cont, snapshot, cursor)) {
+                        throw std::out_of_range(std::string(Policy::name) + ": Dereference out of bounds.");
+                    }
+                }
+                const size_t index = Policy::index(snapshot, cursor);
+                if (index != decoded_index) {
+                    decoded_value = cont->value_at(index, decoded_index, decoded_value);
+                    decoded_index = index;
+                }
+                return decoded_value;
+            }
+
+            OrderedIterator& operator++() noexcept {
+                cursor = Policy::next(snapshot, cursor);
+                return *this;
+            }
+
+            OrderedIterator operator++(int) noexcept {
+                OrderedIterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            bool operator==(const OrderedIterator& other) const noexcept {
+                return cursor == other.cursor && cont == other.cont;
+            }
+
+            bool operator!=(const OrderedIterator& other) const noexcept {
+                return !(*this == other);
+            }
+
+            friend difference_type operator-(const OrderedIterator& a, const OrderedIterator& b) noexcept {
+                return Policy::distance(b.cursor, a.cursor);
+            }
+        };
+
+        template <typename Policy>
+        OrderedIterator<Policy> begin(Policy) const {
+            return OrderedIterator<Policy>(*this, Policy::take_snapshot(*this), Policy::begin_cursor(*this));
+        }
+
+        template <typename Policy>
+        OrderedIterator<Policy> end(Policy) const {
+            return OrderedIterator<Policy>(*this, {}, Policy::end_cursor(*this));
+        }
+
+        OrderedIterator<InsertionOrder> begin() const { return begin(insertion); }
+        OrderedIterator<InsertionOrder> end() const { return end(insertion); }
+    };
+}
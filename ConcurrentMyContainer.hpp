@@ -0,0 +1,74 @@
+//ConcurrentMyContainer.hpp
+#pragma once
+#include "MyContainer.hpp"
+#include <memory>
+#include <mutex>   // For the publication and writer mutexes
+
+namespace Container {
+    // --- ConcurrentMyContainer (many concurrent readers, serialized writers)
+    // RCU-style publication: the current contents are an immutable MyContainer published through a
+    // shared_ptr. Readers take the published container with read() and may run any of the six traversal
+    // orders on it for as long as they hold it. Readers never wait for a write in progress: the only lock
+    // they share with writers guards the O(1) pointer copy / swap, not the copy or the mutation.
+    // Writers are serialized by a second mutex, apply their change to a private copy and publish the copy
+    // with one pointer swap, so every reader sees either the state before or after a complete write.
+    // A write copies the elements (O(n)); use update() to apply several changes with a single copy.
+    template <typename T>
+    class ConcurrentMyContainer {
+    private:
+        // The published, never-modified container. Readers share it; a writer replaces it.
+        std::shared_ptr<const MyContainer<T>> current;
+
+        // Guards only reads and swaps of the 'current' pointer.
+        mutable std::mutex publish_mutex;
+
+        // Serializes writers so that no update is lost between copy and publish.
+        std::mutex writer_mutex;
+
+        void publish(std::shared_ptr<const MyContainer<T>> next) {
+            std::lock_guard<std::mutex> lock(publish_mutex);
+            current.swap(next);
+            // The previous container is released after the lock is dropped, when 'next' is destroyed.
+        }
+
+    public:
+        ConcurrentMyContainer()
+            : current(std::make_shared<const MyContainer<T>>()) {}
+
+        explicit ConcurrentMyContainer(MyContainer<T> initial)
+            : current(std::make_shared<const MyContainer<T>>(std::move(initial))) {}
+
+        ConcurrentMyContainer(const ConcurrentMyContainer&) = delete;
+        ConcurrentMyContainer& operator=(const ConcurrentMyContainer&) = delete;
+
+        // Returns the currently published container. Never waits for a write in progress.
+        // The snapshot (and every iterator taken from it) stays valid and unchanged while it is held.
+        std::shared_ptr<const MyContainer<T>> read() const {
+            std::lock_guard<std::mutex> lock(publish_mutex);
+            return current;
+        }
+
+        size_t size() const {
+            return read()->size();
+        }
+
+        void addElement(const T& element) {
+            update([&](MyContainer<T>& container) { container.addElement(element); });
+        }
+
+        // Throws std::runtime_error if the element is not found; nothing is published in that case.
+        void removeElement(const T& element) {
+            update([&](MyContainer<T>& container) { container.removeElement(element); });
+        }
+
+        // Applies 'mutate' (a callable taking MyContainer<T>&) to a copy of the current contents and
+        // publishes the result. If 'mutate' throws, the published container is left unchanged.
+        template <typename Mutation>
+        void update(Mutation&& mutate) {
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            auto next = std::make_shared<MyContainer<T>>(*read());
+            mutate(*next);
+            publish(std::move(next));
+        }
+    };
+}
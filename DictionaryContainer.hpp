@@ -0,0 +1,285 @@
+//DictionaryContainer.hpp
+#pragma once
+#include "MyContainer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Container {
+    // --- DictionaryContainer (dictionary-encoded strings)
+    // A container of strings for data with many repeated values. Every distinct string is stored once
+    // in a dictionary and the elements are 32-bit codes into it, kept in a MyContainer<std::uint32_t>.
+    // Codes are assigned in order of first appearance; the dictionary also keeps the sorted rank of
+    // every code (rebuilt only when new strings were added), so the sorted orders order the elements by
+    // rank with a counting sort, O(n + distinct), instead of comparing strings. Equal strings keep their
+    // insertion order. removeElement looks the string up once and then compares codes.
+    // All six traversal orders are supported through the same policies as MyContainer; iterators
+    // return references to the dictionary's strings.
+    class DictionaryContainer {
+    private:
+        MyContainer<std::uint32_t> element_codes;
+        // code -> string. A deque never moves its elements, so 'lookup' can key on views of them and
+        // every string is stored once.
+        std::deque<std::string> strings;
+        std::unordered_map<std::string_view, std::uint32_t> lookup; // string -> code
+
+        // code -> rank of its string among the dictionary's strings, and the sorted permutation.
+        mutable std::shared_ptr<const std::vector<std::uint32_t>> rank_cache;
+        mutable std::shared_ptr<const std::vector<size_t>> sorted_cache;
+        mutable std::mutex cache_mutex;
+
+        std::uint32_t intern(const std::string& value) {
+            auto it = lookup.find(value);
+            if (it != lookup.end()) {
+                return it->second;
+            }
+            if (strings.size() > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::length_error("DictionaryContainer: more than 2^32 distinct strings.");
+            }
+            auto code = static_cast<std::uint32_t>(strings.size());
+            strings.push_back(value);
+            lookup.emplace(std::string_view(strings.back()), code);
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            rank_cache.reset();
+            return code;
+        }
+
+        void invalidate_sorted() {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            sorted_cache.reset();
+        }
+
+        // Caller holds cache_mutex.
+        const std::vector<std::uint32_t>& ranks_locked() const {
+            if (!rank_cache) {
+                std::vector<std::uint32_t> by_string(strings.size());
+                for (std::uint32_t code = 0; code < by_string.size(); ++code) {
+                    by_string[code] = code;
+                }
+                std::sort(by_string.begin(), by_string.end(),
+                          [&](std::uint32_t a, std::uint32_t b) { return strings[a] < strings[b]; });
+                std::vector<std::uint32_t> ranks(strings.size());
+                for (std::uint32_t rank = 0; rank < by_string.size(); ++rank) {
+                    ranks[by_string[rank]] = rank;
+                }
+                rank_cache = std::make_shared<const std::vector<std::uint32_t>>(std::move(ranks));
+            }
+            return *rank_cache;
+        }
+
+    public:
+        DictionaryContainer() = default;
+
+        explicit DictionaryContainer(const MyContainer<std::string>& source) {
+            addElements(source.contents().begin(), source.contents().end());
+        }
+
+        // The copy's lookup is rebuilt to view the copied strings.
+        DictionaryContainer(const DictionaryContainer& other)
+            : element_codes(other.element_codes), strings(other.strings) {
+            lookup.reserve(strings.size());
+            for (size_t code = 0; code < strings.size(); ++code) {
+                lookup.emplace(std::string_view(strings[code]), static_cast<std::uint32_t>(code));
+            }
+            std::lock_guard<std::mutex> lock(other.cache_mutex);
+            rank_cache = other.rank_cache;
+            sorted_cache = other.sorted_cache;
+        }
+
+        // Moving keeps the strings in place, so the views in 'lookup' stay valid.
+        // The moved-from container is left empty.
+        DictionaryContainer(DictionaryContainer&& other) noexcept
+            : element_codes(std::move(other.element_codes)), strings(std::move(other.strings)),
+              lookup(std::move(other.lookup)), rank_cache(std::move(other.rank_cache)),
+              sorted_cache(std::move(other.sorted_cache)) {
+            other.strings.clear();
+            other.lookup.clear();
+        }
+
+        DictionaryContainer& operator=(const DictionaryContainer& other) {
+            if (this != &other) {
+                DictionaryContainer copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        DictionaryContainer& operator=(DictionaryContainer&& other) noexcept {
+            if (this != &other) {
+                element_codes = std::move(other.element_codes);
+                strings = std::move(other.strings);
+                lookup = std::move(other.lookup);
+                other.strings.clear();
+                other.lookup.clear();
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                rank_cache = std::move(other.rank_cache);
+                sorted_cache = std::move(other.sorted_cache);
+            }
+            return *this;
+        }
+
+        void addElement(const std::string& element) {
+            element_codes.addElement(intern(element));
+            invalidate_sorted();
+        }
+
+        template <typename InputIt>
+        void addElements(InputIt first, InputIt last) {
+            std::vector<std::uint32_t> batch;
+            for (; first != last; ++first) {
+                batch.push_back(intern(*first));
+            }
+            element_codes.addElements(batch.begin(), batch.end());
+            invalidate_sorted();
+        }
+
+        // Removes every occurrence of 'element'; throws std::runtime_error if there is none.
+        // The string stays in the dictionary.
+        void removeElement(const std::string& element) {
+            auto it = lookup.find(element);
+            if (it == lookup.end()) {
+                throw std::runtime_error("Element not found in container.");
+            }
+            element_codes.removeElement(it->second);
+            invalidate_sorted();
+        }
+
+        size_t size() const noexcept {
+            return element_codes.size();
+        }
+
+        // Number of distinct strings in the dictionary.
+        size_t distinct_count() const noexcept {
+            return strings.size();
+        }
+
+        // The elements as codes (insertion order), and the string of a code.
+        const MyContainer<std::uint32_t>& codes() const noexcept {
+            return element_codes;
+        }
+
+        const std::string& value_of(std::uint32_t code) const {
+            return strings.at(code);
+        }
+
+        // The string at insertion index 'index'.
+        const std::string& operator[](size_t index) const {
+            return strings[element_codes.contents()[index]];
+        }
+
+        // Same contract as MyContainer::sorted_indexes, computed by counting sort over the code ranks.
+        std::shared_ptr<const std::vector<size_t>> sorted_indexes() const {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (!sorted_cache) {
+                const std::vector<std::uint32_t>& ranks = ranks_locked();
+                const std::span<const std::uint32_t> codes = element_codes.contents();
+                std::vector<size_t> starts(ranks.size() + 1, 0);
+                for (std::uint32_t code : codes) {
+                    ++starts[ranks[code] + 1];
+                }
+                for (size_t rank = 1; rank < starts.size(); ++rank) {
+                    starts[rank] += starts[rank - 1];
+                }
+                std::vector<size_t> sorted(codes.size());
+                for (size_t i = 0; i < codes.size(); ++i) {
+                    sorted[starts[ranks[codes[i]]]++] = i;
+                }
+                sorted_cache = std::make_shared<const std::vector<size_t>>(std::move(sorted));
+            }
+            return sorted_cache;
+        }
+
+        // Decodes into a regular container.
+        MyContainer<std::string> decode() const {
+            MyContainer<std::string> result;
+            std::vector<std::string> values;
+            values.reserve(size());
+            for (std::uint32_t code : element_codes.contents()) {
+                values.push_back(strings[code]);
+            }
+            result.addElements(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+            return result;
+        }
+
+        // --- OrderedIterator (the traversal policies of MyContainer over dictionary codes)
+        template <typename Policy>
+        class OrderedIterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string*;
+            using reference = const std::string&;
+            using snapshot_type = typename Policy::snapshot_type;
+
+        private:
+            const DictionaryContainer* cont = nullptr;
+            snapshot_type snapshot{};
+            size_t cursor = 0;
+
+        public:
+            OrderedIterator() = default;
+
+            OrderedIterator(const DictionaryContainer& c, snapshot_type s, size_t start)
+                : cont(&c), snapshot(std::move(s)), cursor(start) {}
+
+            const std::string& operator*() const noexcept(!checked_iterators) {
+                if constexpr (checked_iterators) {
+                    if (!Policy::dereferenceable(*cont, snapshot, cursor)) {
+                        throw std::out_of_range(std::string(Policy::name) + ": Dereference out of bounds.");
+                    }
+                }
+                return (*cont)[Policy::index(snapshot, cursor)];
+            }
+
+            const std::string* operator->() const noexcept(!checked_iterators) {
+                return &**this;
+            }
+
+            OrderedIterator& operator++() noexcept {
+                cursor = Policy::next(snapshot, cursor);
+                return *this;
+            }
+
+            OrderedIterator operator++(int) noexcept {
+                OrderedIterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            bool operator==(const OrderedIterator& other) const noexcept {
+                return cursor == other.cursor && cont == other.cont;
+            }
+
+            bool operator!=(const OrderedIterator& other) const noexcept {
+                return !(*this == other);
+            }
+
+            friend difference_type operator-(const OrderedIterator& a, const OrderedIterator& b) noexcept {
+                return Policy::distance(b.cursor, a.cursor);
+            }
+        };
+
+        template <typename Policy>
+        OrderedIterator<Policy> begin(Policy) const {
+            return OrderedIterator<Policy>(*this, Policy::take_snapshot(*this), Policy::begin_cursor(*this));
+        }
+
+        template <typename Policy>
+        OrderedIterator<Policy> end(Policy) const {
+            return OrderedIterator<Policy>(*this, {}, Policy::end_cursor(*this));
+        }
+
+        OrderedIterator<InsertionOrder> begin() const { return begin(insertion); }
+        OrderedIterator<InsertionOrder> end() const { return end(insertion); }
+    };
+}
@@ -0,0 +1,423 @@
+//ExternalSort.hpp
+#pragma once
+#include "MyContainer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Container {
+    template <typename T>
+    class ExternalSortedRuns;
+
+    // --- ExternalSorter (sorting more data than fits in memory)
+    // Collects values in a buffer of at most memory_budget bytes. Whenever the buffer is full it is
+    // sorted and written to the spill directory as a sorted run, so memory use stays within the budget
+    // however many values are added. finish() returns the runs, which are then traversed in ascending,
+    // descending or side-cross order by a k-way merge (see ExternalSortedRuns).
+    // T must be trivially copyable: runs are raw arrays of T, private to this process and temporary.
+    template <typename T>
+    class ExternalSorter {
+    private:
+        static_assert(binary_codec<T>::bulk, "ExternalSorter needs a trivially copyable element type.");
+
+        std::filesystem::path directory;
+        size_t budget_elements;
+        std::vector<T> buffer;
+        std::vector<std::filesystem::path> runs;
+        size_t total = 0;
+
+        void spill() {
+            if (buffer.empty()) {
+                return;
+            }
+            std::sort(buffer.begin(), buffer.end());
+            runs.push_back(ExternalSortedRuns<T>::write_run(directory, buffer.data(), buffer.size()));
+            buffer.clear();
+        }
+
+    public:
+        // 'memory_budget' is in bytes and bounds the in-memory buffer (at least one element).
+        ExternalSorter(std::filesystem::path spill_directory, size_t memory_budget)
+            : directory(std::move(spill_directory)),
+              budget_elements(std::max<size_t>(1, memory_budget / sizeof(T))) {
+            if (!std::filesystem::is_directory(directory)) {
+                throw std::runtime_error("ExternalSorter: " + directory.string() + " is not a directory.");
+            }
+        }
+
+        ExternalSorter(const ExternalSorter&) = delete;
+        ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+        // Removes the runs written so far if finish() was never called.
+        ~ExternalSorter() {
+            std::error_code ignored;
+            for (const auto& run : runs) {
+                std::filesystem::remove(run, ignored);
+            }
+        }
+
+        void add(const T& value) {
+            if (buffer.capacity() == 0) {
+                buffer.reserve(budget_elements);
+            }
+            buffer.push_back(value);
+            ++total;
+            if (buffer.size() == budget_elements) {
+                spill();
+            }
+        }
+
+        // Adds every value of 'range', e.g. the contents() of a memory-mapped container.
+        template <std::ranges::input_range Range>
+        void add_range(Range&& range) {
+            for (const auto& value : range) {
+                add(value);
+            }
+        }
+
+        // Spills what is left and hands the runs over. The sorter is empty afterwards.
+        ExternalSortedRuns<T> finish() {
+            spill();
+            std::vector<T>().swap(buffer);
+            ExternalSortedRuns<T> result(directory, budget_elements, std::move(runs), total);
+            runs.clear();
+            total = 0;
+            return result;
+        }
+    };
+
+    // --- ExternalSortedRuns (k-way merge traversal of sorted runs on disk)
+    // Owns the run files of an ExternalSorter and deletes them when destroyed. begin(order) returns a
+    // single-pass input iterator over all values in ascending, descending or side-cross order, reading
+    // every run through a small buffer and merging them with a heap. Ascending reads each run forward,
+    // descending reads it backward, and side-cross alternates between one forward and one backward
+    // merge, stopping when they have produced size() values together.
+    // If there are more runs than the memory budget allows buffers for, they are first merged in passes.
+    template <typename T>
+    class ExternalSortedRuns {
+    private:
+        friend class ExternalSorter<T>;
+
+        // Smallest read buffer per run; the number of runs merged at once is limited to keep to it.
+        static constexpr size_t min_block = 256;
+
+        std::filesystem::path directory;
+        size_t budget_elements = 1;
+        std::vector<std::filesystem::path> runs;
+        size_t count = 0;
+
+        static std::filesystem::path unique_run_path(const std::filesystem::path& directory) {
+            static std::atomic<std::uint64_t> counter{0};
+            auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            return directory / ("mycontainer_run_" + std::to_string(stamp) + "_" +
+                                std::to_string(counter.fetch_add(1)) + ".bin");
+        }
+
+        // Removes the files it holds when destroyed; a run write or merge pass that succeeds clears it first,
+        // so a failure leaves neither partial nor orphaned run files behind.
+        struct RunFilesGuard {
+            std::vector<std::filesystem::path> files;
+
+            ~RunFilesGuard() {
+                std::error_code ignored;
+                for (const auto& file : files) {
+                    std::filesystem::remove(file, ignored);
+                }
+            }
+        };
+
+        [[noreturn]] static void cannot_write(const std::filesystem::path& path) {
+            throw std::runtime_error("ExternalSortedRuns: cannot write run " + path.string());
+        }
+
+        static std::ofstream open_run(const std::filesystem::path& path) {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                cannot_write(path);
+            }
+            return out;
+        }
+
+        static void write_values(std::ofstream& out, const T* data, size_t size, const std::filesystem::path& path) {
+            try {
+                write_binary(out, data, size * sizeof(T));
+            } catch (const std::runtime_error&) {
+                cannot_write(path);
+            }
+        }
+
+        static void close_run(std::ofstream& out, const std::filesystem::path& path) {
+            out.close();
+            if (!out) {
+                cannot_write(path);
+            }
+        }
+
+        static std::filesystem::path write_run(const std::filesystem::path& directory, const T* data, size_t size) {
+            std::filesystem::path path = unique_run_path(directory);
+            RunFilesGuard partial{{path}};
+            std::ofstream out = open_run(path);
+            write_values(out, data, size, path);
+            close_run(out, path);
+            partial.files.clear();
+            return path;
+        }
+
+        // Buffered reader of one sorted run, from the front or from the back.
+        class RunReader {
+        private:
+            std::ifstream file;
+            std::vector<T> block;
+            size_t position = 0;      // Next entry of 'block' to hand out
+            size_t unread;            // Elements of the run not read into a block yet
+            size_t block_capacity;
+            bool backward;
+
+            bool refill() {
+                size_t n = std::min(block_capacity, unread);
+                if (n == 0) {
+                    return false;
+                }
+                block.resize(n);
+                if (backward) {
+                    file.seekg(static_cast<std::streamoff>((unread - n) * sizeof(T)));
+                }
+                read_binary(file, block.data(), n * sizeof(T));
+                if (backward) {
+                    std::reverse(block.begin(), block.end());
+                }
+                unread -= n;
+                position = 0;
+                return true;
+            }
+
+        public:
+            RunReader(const std::filesystem::path& path, size_t capacity, bool from_back)
+                : file(path, std::ios::binary), block_capacity(std::max<size_t>(1, capacity)), backward(from_back) {
+                if (!file) {
+                    throw std::runtime_error("ExternalSortedRuns: cannot open run " + path.string());
+                }
+                unread = static_cast<size_t>(std::filesystem::file_size(path) / sizeof(T));
+            }
+
+            // Next value in this reader's direction, or nullptr at the end of the run.
+            const T* next() {
+                if (position == block.size() && !refill()) {
+                    return nullptr;
+                }
+                return &block[position++];
+            }
+        };
+
+        // k-way merge of all runs in one direction.
+        class Merge {
+        private:
+            std::vector<std::unique_ptr<RunReader>> readers;
+            std::vector<std::pair<T, size_t>> heap;  // (value, reader) of each reader's current value
+            bool descending;
+
+            // Heap order: the top is the smallest value (largest when descending), ties by run.
+            bool after(const std::pair<T, size_t>& a, const std::pair<T, size_t>& b) const {
+                if (descending) {
+                    return a.first < b.first || (!(b.first < a.first) && a.second > b.second);
+                }
+                return b.first < a.first || (!(a.first < b.first) && a.second > b.second);
+            }
+
+        public:
+            Merge(const std::vector<std::filesystem::path>& runs, size_t block, bool backward) : descending(backward) {
+                for (size_t i = 0; i < runs.size(); ++i) {
+                    readers.push_back(std::make_unique<RunReader>(runs[i], block, backward));
+                    if (const T* value = readers.back()->next()) {
+                        heap.emplace_back(*value, i);
+                    }
+                }
+                std::make_heap(heap.begin(), heap.end(), [this](const auto& a, const auto& b) { return after(a, b); });
+            }
+
+            const T* next(T& out) {
+                if (heap.empty()) {
+                    return nullptr;
+                }
+                auto later = [this](const auto& a, const auto& b) { return after(a, b); };
+                std::pop_heap(heap.begin(), heap.end(), later);
+                out = heap.back().first;
+                if (const T* value = readers[heap.back().second]->next()) {
+                    heap.back().first = *value;
+                    std::push_heap(heap.begin(), heap.end(), later);
+                } else {
+                    heap.pop_back();
+                }
+                return &out;
+            }
+        };
+
+        // Merges groups of runs until a merge of all of them fits the memory budget ('cursors' merges
+        // run at the same time, e.g. two for side-cross). Each pass replaces 'runs' only once all of its
+        // groups are written; if one fails, the files of that pass are removed and 'runs' is unchanged.
+        void reduce_runs(size_t cursors) {
+            const size_t fan_in = std::max<size_t>(2, budget_elements / (cursors * min_block));
+            while (runs.size() > fan_in) {
+                std::vector<std::filesystem::path> merged;
+                std::vector<std::filesystem::path> sources;  // Runs made redundant by this pass
+                RunFilesGuard written;
+                for (size_t first = 0; first < runs.size(); first += fan_in) {
+                    std::vector<std::filesystem::path> group(runs.begin() + static_cast<std::ptrdiff_t>(first),
+                                                             runs.begin() + static_cast<std::ptrdiff_t>(std::min(runs.size(), first + fan_in)));
+                    if (group.size() == 1) {
+                        merged.push_back(group.front());
+                        continue;
+                    }
+                    const size_t block = std::max<size_t>(1, budget_elements / (group.size() + 1));
+                    Merge merge(group, block, false);
+                    std::vector<T> out;
+                    out.reserve(block);
+                    std::filesystem::path path = unique_run_path(directory);
+                    written.files.push_back(path);
+                    std::ofstream file = open_run(path);
+                    T value;
+                    while (merge.next(value)) {
+                        out.push_back(value);
+                        if (out.size() == block) {
+                            write_values(file, out.data(), out.size(), path);
+                            out.clear();
+                        }
+                    }
+                    write_values(file, out.data(), out.size(), path);
+                    close_run(file, path);
+                    merged.push_back(path);
+                    sources.insert(sources.end(), group.begin(), group.end());
+                }
+                written.files.clear();
+                runs.swap(merged);
+                std::error_code ignored;
+                for (const auto& run : sources) {
+                    std::filesystem::remove(run, ignored);
+                }
+            }
+        }
+
+        ExternalSortedRuns(std::filesystem::path spill_directory, size_t budget, std::vector<std::filesystem::path> files,
+                           size_t total)
+            : directory(std::move(spill_directory)), budget_elements(budget), runs(std::move(files)), count(total) {}
+
+    public:
+        ExternalSortedRuns(ExternalSortedRuns&& other) noexcept
+            : directory(std::move(other.directory)), budget_elements(other.budget_elements),
+              runs(std::exchange(other.runs, {})), count(std::exchange(other.count, 0)) {}
+
+        ExternalSortedRuns(const ExternalSortedRuns&) = delete;
+        ExternalSortedRuns& operator=(const ExternalSortedRuns&) = delete;
+
+        ~ExternalSortedRuns() {
+            std::error_code ignored;
+            for (const auto& run : runs) {
+                std::filesystem::remove(run, ignored);
+            }
+        }
+
+        size_t size() const noexcept { return count; }
+
+        // Number of run files currently on disk.
+        size_t run_count() const noexcept { return runs.size(); }
+
+        // --- Single-pass iterator over one order; compares equal to std::default_sentinel at the end.
+        // Copies share the merge state, as usual for input iterators.
+        template <typename Policy>
+        class OrderedIterator {
+        private:
+            struct State {
+                std::unique_ptr<Merge> forward;
+                std::unique_ptr<Merge> backward;
+                size_t remaining = 0;  // Values left, including 'current'
+                size_t position = 0;   // Position of 'current' in the order
+                T current{};
+            };
+            std::shared_ptr<State> state;
+
+            void read_current() {
+                bool from_back = std::is_same_v<Policy, DescendingOrder> ||
+                                 (std::is_same_v<Policy, SideCrossOrder> && state->position % 2 == 1);
+                (from_back ? state->backward : state->forward)->next(state->current);
+            }
+
+            void advance() {
+                if (state->remaining > 0 && --state->remaining > 0) {
+                    ++state->position;
+                    read_current();
+                }
+            }
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            OrderedIterator() = default;
+
+            OrderedIterator(const std::vector<std::filesystem::path>& runs, size_t total, size_t budget)
+                : state(std::make_shared<State>()) {
+                const size_t cursors = std::is_same_v<Policy, SideCrossOrder> ? 2 : 1;
+                const size_t block = budget / (cursors * std::max<size_t>(1, runs.size()));
+                if (!std::is_same_v<Policy, DescendingOrder>) {
+                    state->forward = std::make_unique<Merge>(runs, block, false);
+                }
+                if (!std::is_same_v<Policy, AscendingOrder>) {
+                    state->backward = std::make_unique<Merge>(runs, block, true);
+                }
+                state->remaining = total;
+                if (total > 0) {
+                    read_current();
+                }
+            }
+
+            const T& operator*() const { return state->current; }
+            const T* operator->() const { return &state->current; }
+
+            OrderedIterator& operator++() {
+                advance();
+                return *this;
+            }
+            void operator++(int) { advance(); }
+
+            friend bool operator==(const OrderedIterator& it, std::default_sentinel_t) {
+                return !it.state || it.state->remaining == 0;
+            }
+        };
+
+        // Starts a traversal in ascending, descending or side_cross order. Each call starts a new merge;
+        // runs are first merged down to what the memory budget allows.
+        template <typename Policy>
+        OrderedIterator<Policy> begin(Policy) {
+            static_assert(std::is_same_v<Policy, AscendingOrder> || std::is_same_v<Policy, DescendingOrder> ||
+                          std::is_same_v<Policy, SideCrossOrder>,
+                          "External traversal supports ascending, descending and side_cross order.");
+            reduce_runs(std::is_same_v<Policy, SideCrossOrder> ? 2 : 1);
+            return OrderedIterator<Policy>(runs, count, budget_elements);
+        }
+
+        template <typename Policy>
+        std::default_sentinel_t end(Policy) const {
+            return std::default_sentinel;
+        }
+
+        // The traversal as a range, e.g. for (const T& x : runs.view(descending)).
+        template <typename Policy>
+        std::ranges::subrange<OrderedIterator<Policy>, std::default_sentinel_t> view(Policy order) {
+            return {begin(order), std::default_sentinel};
+        }
+    };
+}
@@ -0,0 +1,202 @@
+//IngestBuffer.hpp
+#pragma once
+#include "MyContainer.hpp"
+#include "ConcurrentMyContainer.hpp"
+#include <algorithm>
+#include <atomic>  // For the lock-free stack of sealed chunks
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Container {
+    // --- IngestBuffer (lock-free multi-producer ingestion front end)
+    // Each producing thread appends through its own Producer handle into a private chunk, so the hot path
+    // is a plain push_back with no shared state. Full chunks are sealed onto a lock-free (Treiber) stack
+    // with a single compare-and-swap. A single consumer periodically commits everything sealed so far
+    // into a MyContainer (or ConcurrentMyContainer) as one batch.
+    //
+    // Ordering: values of one producer keep their production order, and every commit contains a prefix of
+    // each producer's sealed values; values of different producers may interleave by chunk.
+    // Values still in a producer's open chunk are not visible to commits until that producer flushes
+    // (explicitly, when the chunk fills up, or when the Producer is destroyed).
+    template <typename T>
+    class IngestBuffer {
+    private:
+        struct Chunk {
+            std::vector<T> values;
+            Chunk* next = nullptr;
+        };
+
+        // Head of the stack of sealed chunks (most recently sealed first).
+        std::atomic<Chunk*> sealed{nullptr};
+
+        // Number of values per chunk before a producer seals it.
+        size_t chunk_capacity;
+
+        // Chunks taken from the stack but not committed yet, in seal order (consumer side only). A failed
+        // commit leaves its chunks here, so the next commit retries them ahead of anything sealed since.
+        std::vector<std::unique_ptr<Chunk>> pending;
+
+        // Values are moved into a batch only if moving them back after a failed commit cannot throw;
+        // otherwise they are copied and the chunks keep the originals.
+        static constexpr bool move_out = std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>;
+
+        // Lock-free push: producers never wait for each other or for the consumer.
+        void seal(Chunk* chunk) {
+            chunk->next = sealed.load(std::memory_order_relaxed);
+            while (!sealed.compare_exchange_weak(chunk->next, chunk,
+                                                 std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+
+        // Takes every sealed chunk at once and appends them to 'pending' in the order they were sealed.
+        // Room in 'pending' is reserved before the stack is detached, so no chunk is ever left unowned.
+        // Only the consumer removes chunks, so the ones still on the stack may be walked, and an
+        // unchanged head means nothing was sealed in between.
+        void take_sealed() {
+            Chunk* head = sealed.load(std::memory_order_acquire);
+            do {
+                size_t count = 0;
+                for (Chunk* c = head; c; c = c->next) {
+                    ++count;
+                }
+                pending.reserve(pending.size() + count);
+            } while (!sealed.compare_exchange_weak(head, nullptr, std::memory_order_acquire, std::memory_order_acquire));
+            const size_t first = pending.size();
+            for (; head; head = head->next) {
+                pending.emplace_back(head);
+            }
+            std::reverse(pending.begin() + static_cast<std::ptrdiff_t>(first), pending.end());
+        }
+
+        // Collects the values of every pending chunk, in seal order, into one batch. The chunks stay
+        // pending until the batch is committed.
+        std::vector<T> take_batch() {
+            take_sealed();
+            size_t total = 0;
+            for (const auto& chunk : pending) {
+                total += chunk->values.size();
+            }
+            std::vector<T> batch;
+            batch.reserve(total);
+            for (auto& chunk : pending) {
+                if constexpr (move_out) {
+                    batch.insert(batch.end(), std::make_move_iterator(chunk->values.begin()),
+                                 std::make_move_iterator(chunk->values.end()));
+                } else {
+                    batch.insert(batch.end(), chunk->values.begin(), chunk->values.end());
+                }
+            }
+            return batch;
+        }
+
+        // Commits 'batch' through 'add' (which must leave the batch intact if it throws) and then drops the
+        // pending chunks. If 'add' throws, the values go back to their chunks for the next commit.
+        template <typename Add>
+        size_t commit_batch(Add add) {
+            std::vector<T> batch = take_batch();
+            if (batch.empty()) {
+                pending.clear();
+                return 0;
+            }
+            try {
+                if constexpr (move_out) {
+                    add(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+                } else {
+                    add(batch.cbegin(), batch.cend());
+                }
+            } catch (...) {
+                if constexpr (move_out) {
+                    auto value = batch.begin();
+                    for (auto& chunk : pending) {
+                        for (T& slot : chunk->values) {
+                            slot = std::move(*value++);
+                        }
+                    }
+                }
+                throw;
+            }
+            pending.clear();
+            return batch.size();
+        }
+
+    public:
+        // --- Producer (one per producing thread; not thread-safe itself)
+        class Producer {
+        private:
+            IngestBuffer* owner = nullptr;
+            std::unique_ptr<Chunk> chunk;
+
+        public:
+            explicit Producer(IngestBuffer& buffer) : owner(&buffer) {}
+
+            Producer(Producer&&) noexcept = default;
+            Producer& operator=(Producer&& other) noexcept {
+                if (this != &other) {
+                    flush();
+                    owner = other.owner;
+                    chunk = std::move(other.chunk);
+                }
+                return *this;
+            }
+
+            // Seals whatever is left, so no value is lost when a producer finishes.
+            ~Producer() {
+                flush();
+            }
+
+            void push(const T& value) {
+                if (!chunk) {
+                    chunk = std::make_unique<Chunk>();
+                    chunk->values.reserve(owner->chunk_capacity);
+                }
+                chunk->values.push_back(value);
+                if (chunk->values.size() >= owner->chunk_capacity) {
+                    flush();
+                }
+            }
+
+            // Seals the open chunk (if any) so the next commit will include it.
+            void flush() {
+                if (chunk && !chunk->values.empty()) {
+                    owner->seal(chunk.release());
+                }
+                chunk.reset();
+            }
+        };
+
+        explicit IngestBuffer(size_t chunk_size = 4096)
+            : chunk_capacity(chunk_size == 0 ? 1 : chunk_size) {}
+
+        IngestBuffer(const IngestBuffer&) = delete;
+        IngestBuffer& operator=(const IngestBuffer&) = delete;
+
+        // Values that were sealed but never committed are discarded.
+        ~IngestBuffer() {
+            Chunk* chunks = sealed.exchange(nullptr, std::memory_order_acquire);
+            while (chunks) {
+                std::unique_ptr<Chunk> owned(chunks);
+                chunks = chunks->next;
+            }
+        }
+
+        // Returns a new producer handle. Each thread should use its own; the buffer must outlive it.
+        Producer producer() {
+            return Producer(*this);
+        }
+
+        // Appends everything sealed so far to 'target' as one batch. Returns the number of values added.
+        // Only one thread may commit at a time. If the commit throws, no value is lost: the batch stays
+        // in the buffer and the next commit retries it.
+        size_t commit(MyContainer<T>& target) {
+            return commit_batch([&](auto first, auto last) { target.addElements(first, last); });
+        }
+
+        // Same, but publishes the batch atomically: readers see either none or all of it.
+        size_t commit(ConcurrentMyContainer<T>& target) {
+            return commit_batch([&](auto first, auto last) {
+                target.update([&](MyContainer<T>& container) { container.addElements(first, last); });
+            });
+        }
+    };
+}
@@ -0,0 +1,61 @@
+//MappedFile.hpp
+#pragma once
+#include <cstddef>
+#include <cerrno>
+#include <string>
+#include <system_error> // For std::system_error
+#include <utility>
+#include <fcntl.h>      // For open
+#include <sys/mman.h>   // For mmap, munmap
+#include <sys/stat.h>   // For fstat
+#include <unistd.h>     // For close
+
+namespace Container {
+    // --- MappedFile (read-only memory mapping of a whole file, POSIX)
+    // The mapping is shared with the page cache, so every process mapping the same file reads the same
+    // physical pages and nothing is copied onto the heap. Pages are loaded on first access.
+    // Used by MyContainer<T>::map; throws std::system_error if the file cannot be opened or mapped.
+    class MappedFile {
+    private:
+        const std::byte* bytes = nullptr;
+        size_t length = 0;
+
+    public:
+        explicit MappedFile(const std::string& path) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                throw std::system_error(errno, std::generic_category(), "MappedFile: cannot open " + path);
+            }
+            struct stat info {};
+            if (::fstat(fd, &info) != 0) {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "MappedFile: cannot stat " + path);
+            }
+            length = static_cast<size_t>(info.st_size);
+            if (length > 0) {
+                void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+                if (address == MAP_FAILED) {
+                    int error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "MappedFile: cannot map " + path);
+                }
+                bytes = static_cast<const std::byte*>(address);
+            }
+            // The mapping stays valid after the descriptor is closed.
+            ::close(fd);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+            if (bytes) {
+                ::munmap(const_cast<std::byte*>(bytes), length);
+            }
+        }
+
+        const std::byte* data() const noexcept { return bytes; }
+        size_t size() const noexcept { return length; }
+    };
+}
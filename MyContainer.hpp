@@ -1,635 +1,2235 @@
 //MyContainer.hpp
+#pragma once
 #include <vector>
 #include <iostream>
 #include <algorithm> // For std::sort, std::remove
 #include <stdexcept> // For std::out_of_range, std::runtime_error
 #include <string>    // Included for string tests if needed
+#include <memory>    // For std::shared_ptr (shared iterator snapshots)
+#include <iterator>  // For std::forward_iterator_tag
+#include <cstddef>   // For std::ptrdiff_t
+#include <ranges>    // For std::ranges::view_interface, std::default_sentinel_t
+#include <coroutine> // For the streaming Generator
+#include <exception> // For std::exception_ptr
+#include <utility>   // For std::exchange
+#include <type_traits>
+#include <cmath>     // For std::ceil
+#include <mutex>     // For the thread-safe sorted permutation cache
+#include <atomic>    // For std::atomic_thread_fence (copy-on-write elements)
+#include <cstdint>   // For std::uint64_t
+#include <cstring>   // For std::memcpy (binary format)
+#include <bit>       // For std::endian
+#include <span>      // For contents() (heap or memory-mapped elements)
+#include <fstream>   // For saving to and loading from files
+#include <charconv>  // For std::to_chars / std::from_chars (fast printing and text loading)
+#include <locale>
+#include <thread>    // For the read-ahead thread of load_text
+#include <condition_variable>
+#include <deque>
+#include <functional> // For std::identity, std::ranges::less (keyed orders)
+#include <typeindex>  // For std::type_index (keyed sorted permutation cache)
+#include <concepts>   // For std::equality_comparable
+#include <unordered_set> // For distinct_unordered
+#include "WorkStealingPool.hpp" // For parallel_for_each
+#include "MappedFile.hpp"       // For map()
+
+// Iterator bounds checking.
+// Checked iterators throw std::out_of_range when dereferenced at or past their end.
+// Unchecked iterators skip the test entirely and their operator* is noexcept, which lets
+// the compiler inline and vectorize tight traversal loops.
+// By default iterators are checked in debug builds and unchecked when NDEBUG is defined;
+// define MYCONTAINER_CHECKED_ITERATORS to 0 or 1 to override either way.
+#ifndef MYCONTAINER_CHECKED_ITERATORS
+#ifdef NDEBUG
+#define MYCONTAINER_CHECKED_ITERATORS 0
+#else
+#define MYCONTAINER_CHECKED_ITERATORS 1
+#endif
+#endif
 
 namespace Container {
+    // Compile-time checking policy shared by all iterators of MyContainer.
+    inline constexpr bool checked_iterators = MYCONTAINER_CHECKED_ITERATORS != 0;
+
+    // Cursor value used by reverse traversal to mean "before the first element" (index [-1]).
+    inline constexpr size_t npos = static_cast<size_t>(-1);
+
+    // --- Prefix-key sorting for strings
+    // Comparing std::strings directly chases a pointer into each string's heap buffer on every
+    // comparison. Instead, the strings are sorted by 8-byte big-endian keys taken at a byte offset
+    // ('depth'), held next to their index in one contiguous array. The key is followed by the number of
+    // bytes left after 'depth' (capped at 9), so that "ab" sorts before "ab\0". Keys only tie for strings
+    // that are equal up to depth + 8; if they are longer than that, the tied run is sorted again by the
+    // next 8 bytes (MSD radix on 8-byte digits), otherwise they are equal strings and stay in index order.
+    struct StringSortKey {
+        std::uint64_t prefix;
+        std::uint8_t rest;
+        size_t index;
+    };
+
+    inline StringSortKey string_sort_key(const std::string& value, size_t depth, size_t index) noexcept {
+        std::uint64_t prefix = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            const size_t at = depth + i;
+            prefix = (prefix << 8) | (at < value.size() ? static_cast<unsigned char>(value[at]) : 0u);
+        }
+        const size_t rest = value.size() > depth ? value.size() - depth : 0;
+        return {prefix, static_cast<std::uint8_t>(std::min<size_t>(rest, 9)), index};
+    }
+
+    inline void sort_string_keys(std::span<const std::string> values, std::span<StringSortKey> keys) {
+        auto by_key = [](const StringSortKey& a, const StringSortKey& b) {
+            if (a.prefix != b.prefix) {
+                return a.prefix < b.prefix;
+            }
+            return a.rest != b.rest ? a.rest < b.rest : a.index < b.index;
+        };
+        // Tied runs still to sort, as (first, last, depth); a stack rather than recursion, since long
+        // equal strings would otherwise recurse once per 8 bytes.
+        struct Run { size_t first, last, depth; };
+        std::vector<Run> pending{{0, keys.size(), 0}};
+        while (!pending.empty()) {
+            const Run run = pending.back();
+            pending.pop_back();
+            std::sort(keys.begin() + run.first, keys.begin() + run.last, by_key);
+            for (size_t first = run.first; first < run.last;) {
+                size_t last = first + 1;
+                while (last < run.last && keys[last].prefix == keys[first].prefix && keys[last].rest == keys[first].rest) {
+                    ++last;
+                }
+                if (last - first > 1 && keys[first].rest > 8) {
+                    for (size_t i = first; i < last; ++i) {
+                        keys[i] = string_sort_key(values[keys[i].index], run.depth + 8, keys[i].index);
+                    }
+                    pending.push_back({first, last, run.depth + 8});
+                }
+                first = last;
+            }
+        }
+    }
+
+    // Sorts the element indexes in 'indexes', which must be in increasing order, by value (smallest to
+    // largest). The sort is stable: equal values keep increasing index order, so every sorted traversal
+    // is the same on every run and platform. Strings take the prefix-key path above; arithmetic values
+    // are sorted as contiguous (value, index) pairs, which avoids the indirection of comparing through
+    // indexes and is faster than an unstable index sort; other types use std::stable_sort.
+    template <typename T>
+    void sort_indexes_by_value(std::span<const T> values, std::span<size_t> indexes) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            std::vector<StringSortKey> keys(indexes.size());
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                keys[i] = string_sort_key(values[indexes[i]], 0, indexes[i]);
+            }
+            sort_string_keys(values, keys);
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                indexes[i] = keys[i].index;
+            }
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            std::vector<std::pair<T, size_t>> decorated(indexes.size());
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                decorated[i] = {values[indexes[i]], indexes[i]};
+            }
+            std::sort(decorated.begin(), decorated.end(),
+                [](const std::pair<T, size_t>& a, const std::pair<T, size_t>& b) {
+                    return a.first < b.first || (!(b.first < a.first) && a.second < b.second);
+                });
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                indexes[i] = decorated[i].second;
+            }
+        } else {
+            std::stable_sort(indexes.begin(), indexes.end(),
+                [&](size_t a, size_t b) {
+                    return values[a] < values[b];
+                });
+        }
+    }
+
+    // Builds the indexes 0..n-1 of 'values' sorted by value (smallest to largest).
+    template <typename T>
+    std::vector<size_t> sorted_indexes_of(std::span<const T> values) {
+        std::vector<size_t> indexes(values.size());
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            indexes[i] = i;
+        }
+        sort_indexes_by_value(values, std::span<size_t>(indexes));
+        return indexes;
+    }
+
+    // --- Traversal order policies
+    // Every traversal order is a small stateless policy used by MyContainer<T>::OrderedIterator.
+    // An iterator is a (container, snapshot, cursor) triple, and the policy defines:
+    //   snapshot_type            - state captured once when a begin iterator is created
+    //                              (shared and immutable, so copying an iterator is cheap).
+    //   take_snapshot(c)         - builds that state for container 'c'.
+    //   begin_cursor(c) / end_cursor(c) - cursor values of the begin and end iterators.
+    //   next(s, cursor)          - the cursor after one increment.
+    //   advance(cursor, steps)   - the cursor after 'steps' increments (used to split a traversal).
+    //   distance(from, to)       - number of increments from one cursor to another.
+    //   index(s, cursor)         - the original element index the cursor refers to.
+    //   dereferenceable(c, s, cursor) - whether the cursor may be dereferenced (checked builds).
+    // The policy objects double as tags for MyContainer::begin(order) / end(order). A policy may also
+    // carry state, in which case take_snapshot is a const member function: MyContainer calls it on the
+    // order object it was given (see KeyedOrder).
+
+    // --- 1. Insertion order (left to right).
+    // A live order: the cursor is the element index itself and always reads the container's current state.
+    struct InsertionOrder {
+        struct snapshot_type {};
+        static constexpr const char* name = "OrderIterator";
+
+        template <typename C> static snapshot_type take_snapshot(const C&) { return {}; }
+        template <typename C> static size_t begin_cursor(const C&) { return 0; }
+        template <typename C> static size_t end_cursor(const C& c) { return c.size(); }
+
+        // No bounds check here for increment, as standard iterators can be incremented to 'end'.
+        static size_t next(const snapshot_type&, size_t cursor) noexcept { return cursor + 1; }
+        static size_t advance(size_t cursor, size_t steps) noexcept { return cursor + steps; }
+        static std::ptrdiff_t distance(size_t from, size_t to) noexcept { return static_cast<std::ptrdiff_t>(to - from); }
+        static size_t index(const snapshot_type&, size_t cursor) noexcept { return cursor; }
+
+        template <typename C>
+        static bool dereferenceable(const C& c, const snapshot_type&, size_t cursor) { return cursor < c.size(); }
+    };
+
+    // --- 2./3./5. Sorted orders share one snapshot: the container's cached sorted permutation.
+    struct SortedOrderBase {
+        using snapshot_type = std::shared_ptr<const std::vector<size_t>>;
+
+        template <typename C>
+        static snapshot_type take_snapshot(const C& c) {
+            return c.sorted_indexes();
+        }
+        template <typename C> static size_t begin_cursor(const C&) { return 0; }
+        template <typename C> static size_t end_cursor(const C& c) { return c.size(); }
+
+        static size_t snapshot_size(const snapshot_type& s) noexcept { return s ? s->size() : 0; }
+
+        // Incrementing past the end keeps the iterator at the end.
+        static size_t next(const snapshot_type& s, size_t cursor) noexcept {
+            return cursor < snapshot_size(s) ? cursor + 1 : cursor;
+        }
+        static size_t advance(size_t cursor, size_t steps) noexcept { return cursor + steps; }
+        static std::ptrdiff_t distance(size_t from, size_t to) noexcept { return static_cast<std::ptrdiff_t>(to - from); }
+
+        template <typename C>
+        static bool dereferenceable(const C&, const snapshot_type& s, size_t cursor) { return cursor < snapshot_size(s); }
+    };
+
+    // --- 2. Ascending order (smallest to largest).
+    struct AscendingOrder : SortedOrderBase {
+        static constexpr const char* name = "AscendingOrderIterator";
+        static size_t index(const snapshot_type& s, size_t cursor) noexcept { return (*s)[cursor]; }
+    };
+
+    // --- 3. Descending order (largest to smallest): the sorted snapshot read back to front.
+    struct DescendingOrder : SortedOrderBase {
+        static constexpr const char* name = "DescendingOrderIterator";
+        static size_t index(const snapshot_type& s, size_t cursor) noexcept { return (*s)[s->size() - 1 - cursor]; }
+    };
+
+    // --- 4. Reverse insertion order (right to left).
+    // A live order like InsertionOrder, but the cursor moves backwards and ends "before" index 0.
+    struct ReverseOrder {
+        struct snapshot_type {};
+        static constexpr const char* name = "ReverseOrderIterator";
+
+        template <typename C> static snapshot_type take_snapshot(const C&) { return {}; }
+        // For an empty container size() - 1 wraps around to npos, so begin == end.
+        template <typename C> static size_t begin_cursor(const C& c) { return c.size() - 1; }
+        template <typename C> static size_t end_cursor(const C&) { return npos; }
+
+        static size_t next(const snapshot_type&, size_t cursor) noexcept { return cursor - 1; }
+        static size_t advance(size_t cursor, size_t steps) noexcept { return cursor - steps; }
+        // The cursor counts down, and npos - 0 wraps around to the expected distance of 1.
+        static std::ptrdiff_t distance(size_t from, size_t to) noexcept { return static_cast<std::ptrdiff_t>(from - to); }
+        static size_t index(const snapshot_type&, size_t cursor) noexcept { return cursor; }
+
+        template <typename C>
+        static bool dereferenceable(const C& c, const snapshot_type&, size_t cursor) { return cursor < c.size(); }
+    };
+
+    // --- 5. Side-cross order (smallest, largest, second-smallest, second-largest, ...).
+    // Even cursors read the sorted snapshot from the left, odd cursors from the right.
+    struct SideCrossOrder : SortedOrderBase {
+        static constexpr const char* name = "SideCrossOrderIterator";
+        static size_t index(const snapshot_type& s, size_t cursor) noexcept {
+            return (cursor % 2 == 0) ? (*s)[cursor / 2] : (*s)[s->size() - 1 - cursor / 2];
+        }
+    };
+
+    // --- 6. Middle-out order (middle element, then alternating left and right outwards).
+    // The arrangement only depends on the element count, so the snapshot is just that count
+    // and each position is computed arithmetically instead of being stored.
+    struct MiddleOutOrder {
+        using snapshot_type = size_t;
+        static constexpr const char* name = "MiddleOutOrderIterator";
+
+        template <typename C> static snapshot_type take_snapshot(const C& c) { return c.size(); }
+        template <typename C> static size_t begin_cursor(const C&) { return 0; }
+        template <typename C> static size_t end_cursor(const C& c) { return c.size(); }
+
+        static size_t next(const snapshot_type& count, size_t cursor) noexcept {
+            return cursor < count ? cursor + 1 : cursor;
+        }
+        static size_t advance(size_t cursor, size_t steps) noexcept { return cursor + steps; }
+        static std::ptrdiff_t distance(size_t from, size_t to) noexcept { return static_cast<std::ptrdiff_t>(to - from); }
+
+        // Middle index rounds down: for size 5 it is index 2, for size 4 it is index 1.
+        // Odd cursors step left and even cursors step right; for even sizes the left side
+        // runs out first, so the final odd cursor falls through to the right side.
+        static size_t index(const snapshot_type& count, size_t cursor) noexcept {
+            size_t middle = (count - 1) / 2;
+            if (cursor == 0) {
+                return middle;
+            }
+            size_t offset = (cursor + 1) / 2;
+            if (cursor % 2 == 1 && offset <= middle) {
+                return middle - offset;
+            }
+            return middle + offset;
+        }
+
+        template <typename C>
+        static bool dereferenceable(const C&, const snapshot_type& count, size_t cursor) { return cursor < count; }
+    };
+
+    // Tag objects for MyContainer::begin(order) / end(order).
+    inline constexpr InsertionOrder insertion{};
+    inline constexpr AscendingOrder ascending{};
+    inline constexpr DescendingOrder descending{};
+    inline constexpr ReverseOrder reverse{};
+    inline constexpr SideCrossOrder side_cross{};
+    inline constexpr MiddleOutOrder middle_out{};
+
+    // --- Keyed sorted orders (ascending, descending or side-cross by a custom comparator and projection)
+    // Wraps one of the sorted policies; its snapshot is the permutation sorted by
+    // compare(projection(a), projection(b)) instead of a < b. Projections that return a computed value
+    // are evaluated once per element before sorting, projections that return a reference (e.g. a member
+    // pointer) are applied during comparisons. Built with ascending_by, descending_by and side_cross_by:
+    //     auto by_age = ascending_by(std::ranges::less{}, &Person::age);
+    //     for (auto it = people.begin(by_age); it != people.end(by_age); ++it) ...
+    template <typename Order, typename Compare, typename Proj>
+    struct KeyedOrder : Order {
+        static_assert(std::is_base_of_v<SortedOrderBase, Order>, "KeyedOrder wraps a sorted order policy.");
+
+        Compare compare{};
+        Proj projection{};
+
+        template <typename C>
+        typename Order::snapshot_type take_snapshot(const C& c) const {
+            return c.sorted_indexes(compare, projection);
+        }
+    };
+
+    template <typename Policy>
+    inline constexpr bool is_keyed_order_v = false;
+
+    template <typename Order, typename Compare, typename Proj>
+    inline constexpr bool is_keyed_order_v<KeyedOrder<Order, Compare, Proj>> = true;
+
+    template <typename Compare = std::ranges::less, typename Proj = std::identity>
+    KeyedOrder<AscendingOrder, Compare, Proj> ascending_by(Compare compare = {}, Proj projection = {}) {
+        return {{}, std::move(compare), std::move(projection)};
+    }
+
+    template <typename Compare = std::ranges::less, typename Proj = std::identity>
+    KeyedOrder<DescendingOrder, Compare, Proj> descending_by(Compare compare = {}, Proj projection = {}) {
+        return {{}, std::move(compare), std::move(projection)};
+    }
+
+    template <typename Compare = std::ranges::less, typename Proj = std::identity>
+    KeyedOrder<SideCrossOrder, Compare, Proj> side_cross_by(Compare compare = {}, Proj projection = {}) {
+        return {{}, std::move(compare), std::move(projection)};
+    }
+
+    // --- Generator (a minimal coroutine generator, used for streaming traversals)
+    // A move-only input range: each co_yield suspends the coroutine and exposes the yielded value
+    // through the iterator until the next increment resumes it. Exceptions thrown by the coroutine
+    // are rethrown from begin() / operator++.
+    template <typename T>
+    class Generator {
+    public:
+        struct promise_type {
+            const T* current = nullptr;
+            std::exception_ptr error;
+
+            Generator get_return_object() noexcept {
+                return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+
+            // The yielded object lives in the coroutine frame until it is resumed, so no copy is made.
+            std::suspend_always yield_value(const T& value) noexcept {
+                current = std::addressof(value);
+                return {};
+            }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { error = std::current_exception(); }
+
+            // Generators are pull-only; co_await is not supported inside them.
+            void await_transform() = delete;
+        };
+
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        class iterator {
+        private:
+            handle_type coroutine = nullptr;
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            explicit iterator(handle_type h) : coroutine(h) {}
+
+            const T& operator*() const { return *coroutine.promise().current; }
+            const T* operator->() const { return coroutine.promise().current; }
+
+            iterator& operator++() {
+                coroutine.resume();
+                if (coroutine.promise().error) {
+                    std::rethrow_exception(coroutine.promise().error);
+                }
+                return *this;
+            }
+            void operator++(int) { ++(*this); }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+                return !it.coroutine || it.coroutine.done();
+            }
+        };
+
+        Generator() = default;
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
+        Generator(Generator&& other) noexcept : coroutine(std::exchange(other.coroutine, nullptr)) {}
+        Generator& operator=(Generator&& other) noexcept {
+            if (this != &other) {
+                if (coroutine) {
+                    coroutine.destroy();
+                }
+                coroutine = std::exchange(other.coroutine, nullptr);
+            }
+            return *this;
+        }
+        ~Generator() {
+            if (coroutine) {
+                coroutine.destroy();
+            }
+        }
+
+        // Starts (or continues) the coroutine up to its first yield.
+        iterator begin() {
+            iterator it(coroutine);
+            if (coroutine && !coroutine.done()) {
+                ++it;
+            }
+            return it;
+        }
+        std::default_sentinel_t end() const noexcept { return {}; }
+
+    private:
+        handle_type coroutine = nullptr;
+
+        explicit Generator(handle_type h) noexcept : coroutine(h) {}
+    };
+
+    // --- IncrementalSelector (sorted order without a full sort)
+    // Produces the indexes of 'values' in (value, index) order, selecting 'chunk' of them per pass
+    // with a bounded heap. State is O(chunk) regardless of the number of elements, at the cost of one
+    // O(n log chunk) scan per chunk. Equal values come out by increasing index when ascending and by
+    // decreasing index when descending, matching a stable ascending sort read in either direction.
+    template <typename T>
+    class IncrementalSelector {
+    private:
+        std::span<const T> values;
+        size_t chunk;
+        bool descending;
+        std::vector<size_t> buffer; // The current chunk, in traversal order
+        size_t position = 0;        // Next entry of 'buffer' to hand out
+        size_t last = npos;         // The last index handed out (npos before the first chunk)
+
+        // True if index 'a' comes before index 'b' in this selector's traversal direction.
+        bool precedes(size_t a, size_t b) const {
+            const std::span<const T> v = values;
+            if (descending) {
+                std::swap(a, b);
+            }
+            return v[a] < v[b] || (!(v[b] < v[a]) && a < b);
+        }
+
+        void refill() {
+            buffer.clear();
+            position = 0;
+            auto later = [&](size_t a, size_t b) { return precedes(a, b); };
+            // Max-heap (by traversal order) of the 'chunk' earliest candidates after 'last'.
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (last != npos && !precedes(last, i)) {
+                    continue; // Already handed out in an earlier chunk
+                }
+                if (buffer.size() < chunk) {
+                    buffer.push_back(i);
+                    std::push_heap(buffer.begin(), buffer.end(), later);
+                } else if (precedes(i, buffer.front())) {
+                    std::pop_heap(buffer.begin(), buffer.end(), later);
+                    buffer.back() = i;
+                    std::push_heap(buffer.begin(), buffer.end(), later);
+                }
+            }
+            std::sort_heap(buffer.begin(), buffer.end(), later);
+            if (!buffer.empty()) {
+                last = buffer.back();
+            }
+        }
+
+    public:
+        IncrementalSelector(std::span<const T> v, size_t chunk_size, bool is_descending)
+            : values(v), chunk(chunk_size), descending(is_descending) {}
+
+        // Returns the next index. The caller must not ask for more than values.size() indexes.
+        size_t next() {
+            if (position == buffer.size()) {
+                refill();
+            }
+            return buffer[position++];
+        }
+    };
+
+    // --- Binary format
+    // A saved container is a BinaryHeader, the elements, and optionally the sorted permutation as
+    // 64-bit indexes. Values are stored in the writer's byte order; load rejects files of the other order.
+    // Elements of a "bulk" codec are one raw block of count * element_size bytes starting right after the
+    // header and padded to 8 bytes; other elements are written one by one through binary_codec<T>.
+    struct BinaryHeader {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t flags;
+        std::uint32_t element_size;  // sizeof(T) for bulk elements, 0 otherwise
+        std::uint32_t reserved;
+        std::uint64_t count;
+
+        static constexpr char expected_magic[4] = {'M', 'Y', 'C', 'T'};
+        static constexpr std::uint16_t current_version = 1;
+        static constexpr std::uint16_t has_sorted_indexes = 1;
+        static constexpr std::uint16_t bulk_elements = 2;
+        static constexpr std::uint16_t big_endian = 4;
+    };
+    static_assert(sizeof(BinaryHeader) == 24, "BinaryHeader must have no padding");
+
+    // Reads exactly 'size' bytes or throws, so truncated input is never mistaken for data.
+    inline void read_binary(std::istream& in, void* data, size_t size) {
+        if (size != 0 && !in.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("MyContainer::load: unexpected end of input.");
+        }
+    }
+
+    inline void write_binary(std::ostream& out, const void* data, size_t size) {
+        if (size != 0 && !out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("MyContainer::save: write failed.");
+        }
+    }
+
+    // Customization point for the binary format. The primary template handles trivially copyable
+    // types as raw bytes, which lets save/load move the whole element array with one write/read.
+    // Other types need a specialization with bulk = false and
+    //   static void write(std::ostream& out, const T& value);
+    //   static T read(std::istream& in);
+    template <typename T>
+    struct binary_codec {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Specialize Container::binary_codec<T> to save or load this element type.");
+        static constexpr bool bulk = true;
+
+        static void write(std::ostream& out, const T& value) {
+            write_binary(out, &value, sizeof(T));
+        }
+        static T read(std::istream& in) {
+            T value;
+            read_binary(in, &value, sizeof(T));
+            return value;
+        }
+    };
+
+    // Strings are length-prefixed (64-bit length, then the characters).
+    template <>
+    struct binary_codec<std::string> {
+        static constexpr bool bulk = false;
+
+        static void write(std::ostream& out, const std::string& value) {
+            std::uint64_t length = value.size();
+            write_binary(out, &length, sizeof(length));
+            write_binary(out, value.data(), value.size());
+        }
+        static std::string read(std::istream& in) {
+            std::uint64_t length = 0;
+            read_binary(in, &length, sizeof(length));
+            std::string value;
+            // Grow with the data actually read, so a corrupt length cannot force a huge allocation.
+            constexpr std::uint64_t step = 1 << 16;
+            for (std::uint64_t done = 0; done < length;) {
+                size_t part = static_cast<size_t>(std::min(step, length - done));
+                value.resize(value.size() + part);
+                read_binary(in, value.data() + done, part);
+                done += part;
+            }
+            return value;
+        }
+    };
+
+    // --- Sorted index sidecar
+    // A file holding only the sorted permutation of a container, written next to its data by
+    // save_sorted_index(). The header records the element count and a checksum of the elements, so a
+    // sidecar left over from different data is detected and ignored instead of trusted.
+    struct SortedIndexHeader {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t flags;
+        std::uint32_t reserved;
+        std::uint64_t count;
+        std::uint64_t checksum;
+
+        static constexpr char expected_magic[4] = {'M', 'Y', 'S', 'I'};
+        static constexpr std::uint16_t current_version = 1;
+        static constexpr std::uint16_t big_endian = 1;
+    };
+    static_assert(sizeof(SortedIndexHeader) == 32, "SortedIndexHeader must have no padding");
+
+    // 64-bit checksum of a byte stream, mixed a word at a time so that it runs near memory speed.
+    // It detects changed data, not deliberate tampering.
+    class Checksum {
+    private:
+        std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+        std::uint64_t total = 0;
+        unsigned char tail[8] = {};
+        size_t tail_size = 0;
+
+        static std::uint64_t mix(std::uint64_t state, std::uint64_t word) noexcept {
+            return std::rotl((state ^ word) * 0xFF51AFD7ED558CCDULL, 31) * 0xC4CEB9FE1A85EC53ULL;
+        }
+
+    public:
+        void update(const void* data, size_t size) noexcept {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            total += size;
+            while (size > 0 && tail_size > 0 && tail_size < 8) {
+                tail[tail_size++] = *bytes++;
+                --size;
+            }
+            if (tail_size == 8) {
+                std::uint64_t word;
+                std::memcpy(&word, tail, 8);
+                state = mix(state, word);
+                tail_size = 0;
+            }
+            for (; size >= 8; bytes += 8, size -= 8) {
+                std::uint64_t word;
+                std::memcpy(&word, bytes, 8);
+                state = mix(state, word);
+            }
+            std::memcpy(tail + tail_size, bytes, size);
+            tail_size += size;
+        }
+
+        std::uint64_t value() const noexcept {
+            std::uint64_t word = 0;
+            std::memcpy(&word, tail, tail_size);
+            std::uint64_t h = mix(mix(state, word), total);
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDULL;
+            h ^= h >> 33;
+            return h;
+        }
+    };
+
+    // Output stream buffer that feeds everything written to it into a Checksum, so elements encoded
+    // through binary_codec<T> can be checksummed without materializing the encoding.
+    class ChecksumStreamBuffer : public std::streambuf {
+    private:
+        Checksum& sum;
+
+    protected:
+        std::streamsize xsputn(const char* data, std::streamsize size) override {
+            sum.update(data, static_cast<size_t>(size));
+            return size;
+        }
+        int_type overflow(int_type c) override {
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                char byte = traits_type::to_char_type(c);
+                sum.update(&byte, 1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+    public:
+        explicit ChecksumStreamBuffer(Checksum& checksum) : sum(checksum) {}
+    };
+
     template <typename T>
     class MyContainer {
     private:
-        std::vector<T> elements;
+        // The elements, shared copy-on-write: copies and snapshots of the container point at the same
+        // vector, and the first modification of a shared vector clones it (see modifiable_elements()).
+        std::shared_ptr<std::vector<T>> elements;
+
+        // Set instead for a container returned by map(): the elements are read in place from the mapped
+        // file, which 'mapping' keeps alive. The first modification copies them into 'elements'.
+        std::shared_ptr<const MappedFile> mapping;
+
+        // The elements wherever they are (the vector or the mapped file), returned by contents() and read
+        // by every iterator dereference with a single load. Refreshed after each modification.
+        std::span<const T> current;
+
+        // Incremented by every modification; snapshots keep the epoch they were taken at.
+        std::uint64_t current_epoch = 0;
+
+        // Cached ascending permutation of 'elements' (original indexes sorted by value).
+        // Built lazily by sorted_indexes() and shared by every sorted iterator, view and query;
+        // dropped whenever the elements change. Iterators that already hold it keep their snapshot.
+        mutable std::shared_ptr<const std::vector<size_t>> sorted_cache;
+
+        // Permutations for keyed orders, one per (comparator, projection) in use, so that several orders
+        // can be cached side by side. Dropped with 'sorted_cache'; the oldest entry is evicted beyond
+        // max_keyed_caches. Comparators and projections that are neither empty nor equality comparable
+        // (e.g. capturing lambdas) cannot be told apart and are sorted on every request instead.
+        struct KeyedSortCache {
+            std::type_index type;
+            std::shared_ptr<const void> key;  // A copy of the std::pair<Compare, Proj>.
+            std::shared_ptr<const std::vector<size_t>> sorted;
+        };
+        static constexpr size_t max_keyed_caches = 8;
+        mutable std::vector<KeyedSortCache> keyed_caches;
+
+        // Guards 'sorted_cache' and 'keyed_caches' so that concurrent const access (e.g. many readers of one published
+        // container) may fill it safely: const member functions are safe to call from several threads.
+        mutable std::mutex cache_mutex;
+
+        std::shared_ptr<const std::vector<size_t>> cached_sorted_indexes() const {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            return sorted_cache;
+        }
+
+        void set_sorted_cache(std::shared_ptr<const std::vector<size_t>> sorted) {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            sorted_cache = std::move(sorted);
+        }
+
+        std::vector<KeyedSortCache> cached_keyed_indexes() const {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            return keyed_caches;
+        }
+
+        // Caller holds cache_mutex. Returns null if no entry matches.
+        template <typename Key, typename Compare, typename Proj>
+        std::shared_ptr<const std::vector<size_t>> find_keyed_cache(const Compare& compare, const Proj& projection) const {
+            for (const KeyedSortCache& entry : keyed_caches) {
+                if (entry.type == std::type_index(typeid(Key))) {
+                    const Key& key = *static_cast<const Key*>(entry.key.get());
+                    if (same_function(key.first, compare) && same_function(key.second, projection)) {
+                        return entry.sorted;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        template <typename F>
+        static constexpr bool distinguishable = std::is_empty_v<F> || std::equality_comparable<F>;
+
+        template <typename F>
+        static bool same_function(const F& a, const F& b) {
+            if constexpr (std::is_empty_v<F>) {
+                return true;
+            } else {
+                return a == b;
+            }
+        }
+
+        // One empty vector shared by all empty containers, so default construction does not allocate.
+        static const std::shared_ptr<std::vector<T>>& empty_elements() {
+            static const std::shared_ptr<std::vector<T>> empty = std::make_shared<std::vector<T>>();
+            return empty;
+        }
+
+        // Points 'current' at the vector again (a no-op while mapped).
+        void refresh_contents() noexcept {
+            if (!mapping) {
+                current = std::span<const T>(*elements);
+            }
+        }
+
+        // Refreshes 'current' at the end of a modifying member function, also when it throws.
+        struct ContentsRefresh {
+            MyContainer& owner;
+            ~ContentsRefresh() { owner.refresh_contents(); }
+        };
+
+        // Returns the elements for modification, first cloning them if they are shared with a copy or
+        // a snapshot (copy-on-write). Every modification goes through here, so this also advances the
+        // epoch and drops the sorted permutation cache. The caller refreshes 'current' once it is done
+        // (see ContentsRefresh).
+        std::vector<T>& modifiable_elements() {
+            if (mapping) {
+                elements = std::make_shared<std::vector<T>>(current.begin(), current.end());
+                mapping.reset();
+            } else if (elements.use_count() != 1) {
+                elements = std::make_shared<std::vector<T>>(*elements);
+            } else {
+                // The other owners are gone; make their last reads happen-before our writes.
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+            ++current_epoch;
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            sorted_cache.reset();
+            keyed_caches.clear();
+            return *elements;
+        }
 
     public:
-        MyContainer() = default;
+        MyContainer() : elements(empty_elements()) {}
+
+        // Copies share the elements (copy-on-write) and the immutable sorted permutation, so copying is O(1).
+        MyContainer(const MyContainer& other)
+            : elements(other.elements), mapping(other.mapping), current(other.current),
+              current_epoch(other.current_epoch), sorted_cache(other.cached_sorted_indexes()),
+              keyed_caches(other.cached_keyed_indexes()) {}
+
+        // The moved-from container is left empty.
+        MyContainer(MyContainer&& other) noexcept
+            : elements(std::exchange(other.elements, empty_elements())), mapping(std::move(other.mapping)),
+              current(std::exchange(other.current, {})), current_epoch(other.current_epoch),
+              sorted_cache(std::move(other.sorted_cache)), keyed_caches(std::move(other.keyed_caches)) {}
+
+        MyContainer& operator=(const MyContainer& other) {
+            if (this != &other) {
+                elements = other.elements;
+                mapping = other.mapping;
+                current = other.current;
+                current_epoch = other.current_epoch;
+                auto keyed = other.cached_keyed_indexes();
+                set_sorted_cache(other.cached_sorted_indexes());
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                keyed_caches = std::move(keyed);
+            }
+            return *this;
+        }
+
+        MyContainer& operator=(MyContainer&& other) noexcept {
+            if (this != &other) {
+                elements = std::exchange(other.elements, empty_elements());
+                mapping = std::move(other.mapping);
+                current = std::exchange(other.current, {});
+                current_epoch = other.current_epoch;
+                sorted_cache = std::move(other.sorted_cache);
+                keyed_caches = std::move(other.keyed_caches);
+            }
+            return *this;
+        }
 
         void addElement(const T& element) {
-            elements.push_back(element);
+            ContentsRefresh refresh{*this};
+            modifiable_elements().push_back(element);
+        }
+
+        // Appends a whole batch in insertion order: at most one reallocation and one cache invalidation.
+        // An empty batch changes nothing (not even the epoch or the caches).
+        // Pass move iterators (std::make_move_iterator) to move the values in.
+        template <typename InputIt>
+        void addElements(InputIt first, InputIt last) {
+            if (first == last) {
+                return;
+            }
+            ContentsRefresh refresh{*this};
+            std::vector<T>& values = modifiable_elements();
+            values.insert(values.end(), first, last);
+        }
+
+        // --- Parallel bulk load
+        // Appends every element of 'range' (moved out of an owning rvalue range, copied otherwise) and
+        // leaves the sorted permutation cached, so ascending, descending and side-cross traversal need no
+        // further sort. The work is cut into 'threads' chunks (0 = one per thread of 'pool'). Each chunk
+        // copies its share of a random-access, sized range into pre-sized storage in parallel and sorts
+        // the indexes of its slice; the sorted slices are then merged pairwise, also in parallel. An
+        // already cached permutation of the existing elements is reused as one presorted slice.
+        // If copying throws, the container keeps its previous elements. An empty range changes nothing.
+        template <std::ranges::input_range Range>
+        void bulk_load(Range&& range, size_t threads = 0, WorkStealingPool& pool = WorkStealingPool::shared()) {
+            constexpr bool move_values = !std::is_lvalue_reference_v<Range> &&
+                                         !std::ranges::view<std::remove_cvref_t<Range>>;
+            constexpr bool parallel_copy = std::ranges::random_access_range<Range> &&
+                                           std::ranges::sized_range<Range> &&
+                                           std::is_default_constructible_v<T>;
+            if (threads == 0) {
+                threads = pool.worker_count() + 1;
+            }
+
+            auto source = std::ranges::begin(range);
+            if (source == std::ranges::end(range)) {
+                return;
+            }
+            auto previous = cached_sorted_indexes();
+            ContentsRefresh refresh{*this};
+            std::vector<T>& values = modifiable_elements();
+            const size_t old_size = values.size();
+            auto take = [&](auto it) -> decltype(auto) {
+                if constexpr (move_values) {
+                    return std::ranges::iter_move(it);
+                } else {
+                    return *it;
+                }
+            };
+            try {
+                if constexpr (parallel_copy) {
+                    values.resize(old_size + static_cast<size_t>(std::ranges::size(range)));
+                } else {
+                    for (auto last = std::ranges::end(range); source != last; ++source) {
+                        values.push_back(take(source));
+                    }
+                }
+            } catch (...) {
+                values.erase(values.begin() + static_cast<std::ptrdiff_t>(old_size), values.end());
+                throw;
+            }
+            const size_t total = values.size();
+
+            // Slice boundaries: the previously sorted prefix (if any) is one slice, the rest is cut evenly.
+            const bool reuse_previous = previous && old_size > 0;
+            const size_t split_from = reuse_previous ? old_size : 0;
+            std::vector<size_t> bounds{0};
+            if (reuse_previous) {
+                bounds.push_back(old_size);
+            }
+            const size_t parts = std::max<size_t>(1, std::min(threads, total - split_from));
+            for (size_t i = 1; i <= parts; ++i) {
+                size_t bound = split_from + (total - split_from) * i / parts;
+                if (bound > bounds.back()) {
+                    bounds.push_back(bound);
+                }
+            }
+
+            std::vector<size_t> sorted(total);
+            auto by_value = [&](size_t a, size_t b) { return values[a] < values[b]; };
+            try {
+                pool.parallel_for(bounds.size() - 1, 1, [&](size_t first_slice, size_t last_slice) {
+                    for (size_t slice = first_slice; slice < last_slice; ++slice) {
+                        const size_t first = bounds[slice];
+                        const size_t last = bounds[slice + 1];
+                        if (reuse_previous && slice == 0) {
+                            std::copy(previous->begin(), previous->end(), sorted.begin());
+                            continue;
+                        }
+                        if constexpr (parallel_copy) {
+                            for (size_t i = std::max(first, old_size); i < last; ++i) {
+                                values[i] = take(source + static_cast<std::ptrdiff_t>(i - old_size));
+                            }
+                        }
+                        for (size_t i = first; i < last; ++i) {
+                            sorted[i] = i;
+                        }
+                        sort_indexes_by_value(std::span<const T>(values), std::span<size_t>(sorted).subspan(first, last - first));
+                    }
+                });
+            } catch (...) {
+                values.erase(values.begin() + static_cast<std::ptrdiff_t>(old_size), values.end());
+                throw;
+            }
+
+            // Merge neighbouring slices pairwise until one sorted permutation is left.
+            std::vector<size_t> merged(total);
+            while (bounds.size() > 2) {
+                const size_t pairs = (bounds.size() - 1) / 2;
+                pool.parallel_for(pairs, 1, [&](size_t first_pair, size_t last_pair) {
+                    for (size_t pair = first_pair; pair < last_pair; ++pair) {
+                        auto first = sorted.begin() + bounds[2 * pair];
+                        auto middle = sorted.begin() + bounds[2 * pair + 1];
+                        auto last = sorted.begin() + bounds[2 * pair + 2];
+                        std::merge(first, middle, middle, last, merged.begin() + bounds[2 * pair], by_value);
+                    }
+                });
+                std::vector<size_t> next_bounds;
+                for (size_t i = 0; i < bounds.size(); i += 2) {
+                    next_bounds.push_back(bounds[i]);
+                }
+                if ((bounds.size() - 1) % 2 == 1) {
+                    // An odd slice out is carried over unmerged.
+                    std::copy(sorted.begin() + bounds[bounds.size() - 2], sorted.end(),
+                              merged.begin() + bounds[bounds.size() - 2]);
+                    next_bounds.push_back(bounds.back());
+                }
+                bounds = std::move(next_bounds);
+                sorted.swap(merged);
+            }
+            set_sorted_cache(std::make_shared<const std::vector<size_t>>(std::move(sorted)));
         }
 
         void removeElement(const T& element) {
-            auto original_size = elements.size();
-            auto it = std::remove(elements.begin(), elements.end(), element);
-            elements.erase(it, elements.end());
-            
-            if (elements.size() == original_size) {
+            // Look first, so that a failed removal neither clones shared elements nor drops the cache.
+            const std::span<const T> current = contents();
+            if (std::find(current.begin(), current.end(), element) == current.end()) {
                 throw std::runtime_error("Element not found in container.");
             }
+            ContentsRefresh refresh{*this};
+            std::vector<T>& values = modifiable_elements();
+            values.erase(std::remove(values.begin(), values.end(), element), values.end());
+        }
+
+        // --- Epoch-versioned snapshots
+        // Returns an immutable snapshot of the current contents, tagged with the current epoch().
+        // It shares the elements (and the sorted permutation) instead of copying them, supports every
+        // traversal order and query, and never changes: a later modification of this container clones
+        // the elements first. Long scans should iterate a snapshot rather than the live container, so
+        // that concurrent removeElement calls cannot shift the positions they read.
+        std::shared_ptr<const MyContainer<T>> snapshot() const {
+            return std::make_shared<const MyContainer<T>>(*this);
+        }
+
+        // Number of modifications applied to this container's contents (copies start from the source's epoch).
+        std::uint64_t epoch() const noexcept {
+            return current_epoch;
+        }
+
+        // Returns the original indexes sorted by value (smallest to largest). Equal values keep their
+        // insertion order, so ascending, descending (ties in reverse insertion order) and side-cross
+        // traversals are reproducible. The first call after a modification sorts; later calls return
+        // the cached permutation. Concurrent first calls sort only once: the others wait for and share that result.
+        std::shared_ptr<const std::vector<size_t>> sorted_indexes() const {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (!sorted_cache) {
+                sorted_cache = std::make_shared<const std::vector<size_t>>(sorted_indexes_of(contents()));
+            }
+            return sorted_cache;
+        }
+
+        // Returns the original indexes sorted by compare(projection(a), projection(b)), with equivalent
+        // keys in insertion order; the snapshot of the keyed orders (ascending_by etc.). Computed
+        // values are projected once per element (decorate-sort-undecorate). The result is cached per
+        // (comparator, projection) next to the default permutation, until the next modification.
+        // The comparator and projection run without the cache lock held, so they may themselves query
+        // this container; concurrent first calls may each sort, and the first to finish is cached.
+        template <typename Compare, typename Proj = std::identity>
+        std::shared_ptr<const std::vector<size_t>> sorted_indexes(Compare compare, Proj projection = {}) const {
+            using Key = std::pair<Compare, Proj>;
+            constexpr bool cacheable = distinguishable<Compare> && distinguishable<Proj>;
+            if constexpr (cacheable) {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                if (auto cached = find_keyed_cache<Key>(compare, projection)) {
+                    return cached;
+                }
+            }
+
+            const std::span<const T> values = contents();
+            std::vector<size_t> indexes(values.size());
+            using Projected = std::invoke_result_t<Proj&, const T&>;
+            if constexpr (std::is_lvalue_reference_v<Projected>) {
+                for (size_t i = 0; i < indexes.size(); ++i) {
+                    indexes[i] = i;
+                }
+                std::stable_sort(indexes.begin(), indexes.end(), [&](size_t a, size_t b) {
+                    return std::invoke(compare, std::invoke(projection, values[a]), std::invoke(projection, values[b]));
+                });
+            } else {
+                std::vector<std::pair<std::remove_cvref_t<Projected>, size_t>> decorated;
+                decorated.reserve(values.size());
+                for (size_t i = 0; i < values.size(); ++i) {
+                    decorated.emplace_back(std::invoke(projection, values[i]), i);
+                }
+                std::stable_sort(decorated.begin(), decorated.end(), [&](const auto& a, const auto& b) {
+                    return std::invoke(compare, a.first, b.first);
+                });
+                for (size_t i = 0; i < decorated.size(); ++i) {
+                    indexes[i] = decorated[i].second;
+                }
+            }
+            auto sorted = std::make_shared<const std::vector<size_t>>(std::move(indexes));
+
+            if constexpr (cacheable) {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                if (auto cached = find_keyed_cache<Key>(compare, projection)) {
+                    return cached; // Another thread sorted the same key meanwhile.
+                }
+                if (keyed_caches.size() == max_keyed_caches) {
+                    keyed_caches.erase(keyed_caches.begin());
+                }
+                keyed_caches.push_back({std::type_index(typeid(Key)),
+                                        std::make_shared<const Key>(std::move(compare), std::move(projection)), sorted});
+            }
+            return sorted;
+        }
+
+        // True if the sorted permutation is currently cached (sorted queries will not sort).
+        bool has_sorted_indexes() const {
+            return cached_sorted_indexes() != nullptr;
         }
 
         size_t size() const {
-            return elements.size();
+            return contents().size();
         }
 
+        // The elements in insertion order. Not available for a memory-mapped container (see map()),
+        // whose elements are not in a std::vector: use contents() there.
         const std::vector<T>& getElements() const {
-            return elements;
+            if (mapping) {
+                throw std::logic_error("MyContainer::getElements: elements are memory-mapped; use contents().");
+            }
+            return *elements;
+        }
+
+        // The elements in insertion order, wherever they are stored (on the heap or in a mapped file).
+        // Valid until the next modification.
+        std::span<const T> contents() const noexcept {
+            return current;
+        }
+
+        // True if the elements are read in place from a file mapped by map().
+        bool is_mapped() const noexcept {
+            return mapping != nullptr;
         }
 
         template <typename U>
         friend std::ostream& operator<<(std::ostream& os, const MyContainer<U>& container);
 
-        // --- 1. OrderIterator (Iterates in insertion order)
-        class OrderIterator {
+    private:
+        // Coroutine body of stream(); the batch buffer is reused and yielded by reference.
+        template <typename Policy>
+        Generator<std::vector<T>> stream_batches(Policy order, size_t batch_size) const {
+            const std::span<const T> values = contents();
+            const size_t n = values.size();
+            std::vector<T> batch;
+            batch.reserve(std::min(batch_size, n));
+
+            if constexpr (std::is_base_of_v<SortedOrderBase, Policy> && !is_keyed_order_v<Policy>) {
+                // Side-cross draws from both ends; ascending/descending only use one selector.
+                IncrementalSelector<T> from_left(values, batch_size, false);
+                IncrementalSelector<T> from_right(values, batch_size, true);
+                for (size_t position = 0; position < n; ++position) {
+                    bool left = std::is_same_v<Policy, AscendingOrder> ||
+                                (std::is_same_v<Policy, SideCrossOrder> && position % 2 == 0);
+                    batch.push_back(values[left ? from_left.next() : from_right.next()]);
+                    if (batch.size() == batch_size) {
+                        co_yield batch;
+                        batch.clear();
+                    }
+                }
+            } else {
+                // Live and count-based orders need no more than their (O(1)) snapshot; keyed orders
+                // use their sorted permutation.
+                auto snapshot = order.take_snapshot(*this);
+                size_t cursor = Policy::begin_cursor(*this);
+                for (size_t position = 0; position < n; ++position) {
+                    batch.push_back(values[Policy::index(snapshot, cursor)]);
+                    cursor = Policy::next(snapshot, cursor);
+                    if (batch.size() == batch_size) {
+                        co_yield batch;
+                        batch.clear();
+                    }
+                }
+            }
+            if (!batch.empty()) {
+                co_yield batch;
+            }
+        }
+
+    public:
+
+        // End marker of an OrderView: only remembers the final cursor of its traversal.
+        template <typename Policy>
+        class OrderedSentinel {
+        private:
+            size_t cursor = 0;
+
+        public:
+            OrderedSentinel() = default;
+            explicit OrderedSentinel(size_t end_cursor) : cursor(end_cursor) {}
+
+            size_t position() const noexcept { return cursor; }
+        };
+
+        // --- OrderedIterator (one iterator template for every traversal order)
+        // Policy is one of the traversal order policies above; it decides where the iterator
+        // starts and ends, how it advances and which element each position refers to.
+        template <typename Policy>
+        class OrderedIterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+            using snapshot_type = typename Policy::snapshot_type;
+
         private:
-            // the iterator holds a valid reference to the parent container,
-            // which remains valid even if the underlying 'elements' vector reallocates.
-            const MyContainer<T>& cont;
-            size_t current_index;
+            // The iterator holds a pointer to the parent container, which remains valid even if
+            // the underlying 'elements' vector reallocates (and keeps the iterator assignable).
+            const MyContainer<T>* cont = nullptr;
+
+            // The order's state captured at creation (e.g. sorted indexes). Shared between copies.
+            snapshot_type snapshot{};
+
+            // The current position, interpreted by the policy.
+            size_t cursor = 0;
 
         public:
-            // Constructor for OrderIterator.
-            // Initializes the iterator with a reference to the container and a starting index.
-            OrderIterator(const MyContainer<T>& c, size_t index)
-                : cont(c), current_index(index) {}
-            
+            OrderedIterator() = default;
+
+            // Constructor for OrderedIterator.
+            // Initializes the iterator with a reference to the container, the order's snapshot and a starting cursor.
+            OrderedIterator(const MyContainer<T>& c, snapshot_type s, size_t start)
+                : cont(&c), snapshot(std::move(s)), cursor(start) {}
+
             // Dereference operator (*it).
             // Provides access to the element currently pointed to by the iterator.
-            const T& operator*() const {
-                // Access elements through the container's getElements() method,
-                // ensuring access to the current, valid underlying vector.
-                if (current_index >= cont.size()) {
-                    throw std::out_of_range("OrderIterator: Dereference out of bounds.");
+            const T& operator*() const noexcept(!checked_iterators) {
+                // The bounds check is only compiled into checked builds.
+                if constexpr (checked_iterators) {
+                    if (!Policy::dereferenceable(*cont, snapshot, cursor)) {
+                        throw std::out_of_range(std::string(Policy::name) + ": Dereference out of bounds.");
+                    }
                 }
-                return cont.getElements()[current_index];
+                return cont->contents()[Policy::index(snapshot, cursor)];
+            }
+
+            const T* operator->() const noexcept(!checked_iterators) {
+                return &**this;
             }
 
             // Pre-increment operator (++it).
-            // Advances the iterator to the next element in the container.
-            OrderIterator& operator++() {
-                // No bounds check here for increment, as standard iterators can be incremented to 'end'.
-                // Dereference operator handles out-of-bounds access.
-                current_index++;
+            // Advances the iterator to the next element in the policy's order.
+            OrderedIterator& operator++() noexcept {
+                cursor = Policy::next(snapshot, cursor);
                 return *this;
             }
+
             // Post-increment operator (it++).
-            // Advances the iterator to the next element, but returns a copy of the iterator's state before the increment.  
-            OrderIterator operator++(int) {
-                OrderIterator temp = *this;
+            // Advances the iterator, but returns a copy of the iterator's state *before* the increment.
+            OrderedIterator operator++(int) noexcept {
+                OrderedIterator temp = *this;
                 ++(*this);
                 return temp;
             }
 
             // Equality operator (it1 == it2).
-            // Compares two OrderIterator objects for equality.
-            bool operator==(const OrderIterator& other) const {
-                // Equality check now compares the container references, ensuring both iterators
-                // belong to the same logical container instance.
-                return current_index == other.current_index && &cont == &other.cont;
+            // Iterators are equal if they are at the same position AND refer to the same container instance.
+            bool operator==(const OrderedIterator& other) const noexcept {
+                return cursor == other.cursor && cont == other.cont;
             }
+
             // Inequality operator (it1 != it2).
-            // Compares two OrderIterator objects for inequality.
-            bool operator!=(const OrderIterator& other) const {
+            bool operator!=(const OrderedIterator& other) const noexcept {
                 return !(*this == other);
             }
-        };
 
-        // Begin and end methods for OrderIterator.
-        OrderIterator begin_order() const {
-            return OrderIterator(*this, 0);
-        }
+            // Number of increments between two iterators of the same traversal.
+            friend difference_type operator-(const OrderedIterator& a, const OrderedIterator& b) noexcept {
+                return Policy::distance(b.cursor, a.cursor);
+            }
 
-        OrderIterator end_order() const {
-            return OrderIterator(*this, elements.size());
-        }
+            // Comparison against the end marker of an OrderView (it == view.end()).
+            friend bool operator==(const OrderedIterator& it, const OrderedSentinel<Policy>& s) noexcept {
+                return it.cursor == s.position();
+            }
 
-        // --- 2. AscendingOrderIterator (sorted from smallest to largest); 
-        class AscendingOrderIterator { 
-        private:
-            // A constant reference to the parent MyContainer instance.
-            // This allows the iterator to access the container's elements via getElements().
-            const MyContainer<T>& cont;
+            // Distance to the end marker, which makes OrderView a sized range.
+            friend difference_type operator-(const OrderedSentinel<Policy>& s, const OrderedIterator& it) noexcept {
+                return Policy::distance(it.cursor, s.position());
+            }
 
-            // A vector to store the indexes of the original elements, sorted according to their values.
-            // This forms the "snapshot" for this specific iterator.
-            std::vector<size_t> indexes;
+            friend difference_type operator-(const OrderedIterator& it, const OrderedSentinel<Policy>& s) noexcept {
+                return -(s - it);
+            }
+        };
 
-            // The current position within the `indexes` vector during iteration.
-            size_t current_index_in_sorted_indexes;
+        // --- OrderView (a std::ranges::view over one traversal order)
+        // Holds a begin iterator and the end cursor, so it can be composed with the standard range
+        // adaptors (e.g. container.view(ascending) | std::views::take(3)) without materializing anything.
+        // Like the iterators, a view refers to the container and must not outlive it.
+        template <typename Policy>
+        class OrderView : public std::ranges::view_interface<OrderView<Policy>> {
+        private:
+            OrderedIterator<Policy> first;
+            OrderedSentinel<Policy> last;
 
         public:
-            
-            // Constructor for AscendingOrderIterator.
-            // Initializes the iterator by sorting indexes based on the container's elements.
-            // This constructor performs a sort operation each time it's called.
-            // is_end_iterator_flag: true if this is an end iterator, false for begin.
-            AscendingOrderIterator(const MyContainer<T>& cont, bool is_end_iterator_flag)
-                : cont(cont) { // current_index_in_sorted_indexes will be set later
-
-                // Populate 'indexes' with initial order (0 to size-1)
-                for (size_t i = 0; i < cont.getElements().size(); ++i) {
-                    indexes.push_back(i);
-                }
-
-                // Sort 'indexes' based on the values in the container (lambda function).
-                // This lambda captures the container reference and sorts indexes based on the elements.
-                std::sort(indexes.begin(), indexes.end(),
-                    [&](size_t a, size_t b) {
-                        // Ensure sorting is stable and handles equal elements correctly if needed
-                        return cont.getElements()[a] < cont.getElements()[b];
-                    });
-
-                if (is_end_iterator_flag) { // For end iterator
-                    current_index_in_sorted_indexes = indexes.size();
-                } else { // For begin iterator
-                    current_index_in_sorted_indexes = 0;
-                }
-            }
-
-            //Dereference operator (*it).
-            //Provides access to the element currently pointed to by the iterator.
-            const T& operator*() const {
-                // Ensure the current index is within valid bounds of the sorted indexes.
-                if (current_index_in_sorted_indexes >= indexes.size()) {
-                    throw std::out_of_range("AscendingOrderIterator: Dereference out of bounds.");
-                }
-                // Use the current sorted index to access the actual element from the MyContainer.
-                return cont.getElements()[indexes[current_index_in_sorted_indexes]];
-            }
-
-            //Pre-increment operator (++it).
-            //Advances the iterator to the next element in the sorted sequence.
-            AscendingOrderIterator& operator++() {
-                if (current_index_in_sorted_indexes < indexes.size()) {
-                    current_index_in_sorted_indexes++; // Move to the next index in our sorted list
-                } 
-                return *this;
-            }
+            OrderView() = default;
 
-            //Post-increment operator (it++).
-            //Advances the iterator to the next element, but returns a copy of the iterator's state
-            // *before* the increment.
-            AscendingOrderIterator operator++(int) {
-                AscendingOrderIterator temp = *this; // Save current state
-                ++(*this); // Increment actual iterator
-                return temp; // Return saved state
-            }
+            OrderView(OrderedIterator<Policy> begin_it, size_t end_cursor)
+                : first(std::move(begin_it)), last(end_cursor) {}
+
+            OrderedIterator<Policy> begin() const { return first; }
+            OrderedSentinel<Policy> end() const { return last; }
+
+            size_t size() const { return static_cast<size_t>(last - first); }
+        };
+
+        // Returns a view over the given order, e.g. view(side_cross).
+        template <typename Policy>
+        OrderView<Policy> view(Policy order) const {
+            return OrderView<Policy>(begin(order), Policy::end_cursor(*this));
+        }
 
-            //Equality operator (it1 == it2).
-            //Compares two AscendingOrderIterator objects for equality.
-            bool operator==(const AscendingOrderIterator& other) const {
-                // Iterators are equal if their internal index is the same AND they refer to the same container instance.
-                return current_index_in_sorted_indexes == other.current_index_in_sorted_indexes && &cont == &other.cont;
+        // Splits 'order' into n disjoint, consecutive views that together cover it exactly once, e.g. for
+        // handing parts of a traversal to an external task scheduler. The sizes differ by at most one
+        // (some are empty when n > size()). The views partition the traversal sequence itself, so the
+        // parts of side_cross and middle_out interleave in the underlying vector. All parts share one
+        // snapshot, and each is positioned in O(1) without stepping through the sequence.
+        template <typename Policy>
+        std::vector<OrderView<Policy>> split(Policy order, size_t n) const {
+            if (n == 0) {
+                throw std::invalid_argument("MyContainer::split: number of parts must be positive.");
+            }
+            const auto snapshot = order.take_snapshot(*this);
+            const size_t first_cursor = Policy::begin_cursor(*this);
+            const size_t count = size();
+            std::vector<OrderView<Policy>> parts;
+            parts.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                size_t first = count * i / n;
+                size_t last = count * (i + 1) / n;
+                parts.emplace_back(OrderedIterator<Policy>(*this, snapshot, Policy::advance(first_cursor, first)),
+                                   Policy::advance(first_cursor, last));
             }
+            return parts;
+        }
 
-            //Inequality operator (it1 != it2).
-            //Compares two AscendingOrderIterator objects for inequality.
-            bool operator!=(const AscendingOrderIterator& other) const {
-                return !(*this == other);
+        // Generic begin and end methods, selected by an order tag (e.g. begin(ascending)).
+        // Only begin iterators take a snapshot; end iterators just mark the final position.
+        template <typename Policy>
+        OrderedIterator<Policy> begin(Policy order) const {
+            return OrderedIterator<Policy>(*this, order.take_snapshot(*this), Policy::begin_cursor(*this));
+        }
+
+        template <typename Policy>
+        OrderedIterator<Policy> end(Policy) const {
+            return OrderedIterator<Policy>(*this, {}, Policy::end_cursor(*this));
+        }
+
+        // --- Streaming traversal
+        // Returns a coroutine generator that yields the elements of 'order' in batches (copies) of up to
+        // batch_size elements. Traversal state stays bounded by batch_size: insertion, reverse and
+        // middle-out positions are computed on the fly, and the sorted orders are produced by
+        // incremental selection instead of an up-front sort (one O(n log batch_size) pass per batch).
+        // A full sorted stream therefore costs O(n^2 / batch_size * log batch_size): use batches of
+        // thousands of elements, or a sorted traversal (which sorts once) if memory allows.
+        // The container must outlive the generator and must not be modified while streaming.
+        static constexpr size_t default_stream_batch = 4096;
+
+        template <typename Policy>
+        Generator<std::vector<T>> stream(Policy order, size_t batch_size = default_stream_batch) const {
+            if (batch_size == 0) {
+                throw std::invalid_argument("MyContainer::stream: batch size must be positive.");
             }
-            
-        };
+            return stream_batches(order, batch_size);
+        }
 
-        // Begin and end methods for AscendingOrderIterator.
-        AscendingOrderIterator begin_ascending_order() const {
-            return AscendingOrderIterator(*this, false); // false indicates this is a begin iterator
+        // --- Parallel traversal
+        // Calls fn(element) for every element of 'order' on the threads of 'pool'. The positions of the
+        // order are split into chunks of 'grain' consecutive positions (0 picks a grain automatically);
+        // fn sees the elements of one chunk in traversal order, but chunks run concurrently and in any
+        // order, so fn must be safe to call from several threads. All chunks of a sorted order read the
+        // single cached sorted permutation. The first exception thrown by fn is rethrown here.
+        // The container must not be modified during the call (run it on a snapshot() if it may be).
+        template <typename Policy, typename Fn>
+        void parallel_for_each(Policy order, Fn fn, size_t grain = 0,
+                               WorkStealingPool& pool = WorkStealingPool::shared()) const {
+            const std::span<const T> values = contents();
+            const auto snapshot = order.take_snapshot(*this);
+            const size_t first_cursor = Policy::begin_cursor(*this);
+            pool.parallel_for(values.size(), grain, [&](size_t first, size_t last) {
+                size_t cursor = Policy::advance(first_cursor, first);
+                for (size_t position = first; position < last; ++position) {
+                    fn(values[Policy::index(snapshot, cursor)]);
+                    cursor = Policy::next(snapshot, cursor);
+                }
+            });
         }
-        
-        AscendingOrderIterator end_ascending_order() const {
-            return AscendingOrderIterator(*this, true); // true indicates this is an end iterator
+
+        // The container itself is a range in insertion order (e.g. for (const auto& x : container)).
+        OrderedIterator<InsertionOrder> begin() const { return begin(insertion); }
+        OrderedIterator<InsertionOrder> end() const { return end(insertion); }
+
+        // --- Named iterators for the six orders.
+        using OrderIterator = OrderedIterator<InsertionOrder>;
+        using AscendingOrderIterator = OrderedIterator<AscendingOrder>;
+        using DescendingOrderIterator = OrderedIterator<DescendingOrder>;
+        using ReverseOrderIterator = OrderedIterator<ReverseOrder>;
+        using SideCrossOrderIterator = OrderedIterator<SideCrossOrder>;
+        using MiddleOutOrderIterator = OrderedIterator<MiddleOutOrder>;
+
+        // 1. Insertion order.
+        OrderIterator begin_order() const { return begin(insertion); }
+        OrderIterator end_order() const { return end(insertion); }
+
+        // 2. Ascending order (smallest to largest).
+        AscendingOrderIterator begin_ascending_order() const { return begin(ascending); }
+        AscendingOrderIterator end_ascending_order() const { return end(ascending); }
+
+        // 3. Descending order (largest to smallest).
+        DescendingOrderIterator begin_descending_order() const { return begin(descending); }
+        DescendingOrderIterator end_descending_order() const { return end(descending); }
+
+        // 4. Reverse insertion order.
+        ReverseOrderIterator begin_reverse_order() const { return begin(reverse); }
+        ReverseOrderIterator end_reverse_order() const { return end(reverse); }
+
+        // 5. Side-cross order (smallest, largest, second-smallest, second-largest, ...).
+        SideCrossOrderIterator begin_side_cross_order() const { return begin(side_cross); }
+        SideCrossOrderIterator end_side_cross_order() const { return end(side_cross); }
+
+        // 6. Middle-out order (middle, then alternating left and right).
+        MiddleOutOrderIterator begin_middle_out_order() const { return begin(middle_out); }
+        MiddleOutOrderIterator end_middle_out_order() const { return end(middle_out); }
+
+        // 2./3./5. with a custom comparator and projection (see ascending_by); begin and end must be
+        // called with the same comparator and projection types.
+        template <typename Compare, typename Proj = std::identity>
+        auto begin_ascending_order(Compare compare, Proj projection = {}) const {
+            return begin(ascending_by(std::move(compare), std::move(projection)));
+        }
+        template <typename Compare, typename Proj = std::identity>
+        auto end_ascending_order(Compare compare, Proj projection = {}) const {
+            return end(ascending_by(std::move(compare), std::move(projection)));
+        }
+        template <typename Compare, typename Proj = std::identity>
+        auto begin_descending_order(Compare compare, Proj projection = {}) const {
+            return begin(descending_by(std::move(compare), std::move(projection)));
+        }
+        template <typename Compare, typename Proj = std::identity>
+        auto end_descending_order(Compare compare, Proj projection = {}) const {
+            return end(descending_by(std::move(compare), std::move(projection)));
+        }
+        template <typename Compare, typename Proj = std::identity>
+        auto begin_side_cross_order(Compare compare, Proj projection = {}) const {
+            return begin(side_cross_by(std::move(compare), std::move(projection)));
+        }
+        template <typename Compare, typename Proj = std::identity>
+        auto end_side_cross_order(Compare compare, Proj projection = {}) const {
+            return end(side_cross_by(std::move(compare), std::move(projection)));
         }
 
-        // --- 3. DescendingOrderIterator (sorted from largest to smallest)
-        class DescendingOrderIterator { 
-        private:
-            // A constant reference to the parent MyContainer instance.
-            // This allows the iterator to access the container's elements via getElements().
-            const MyContainer<T>& cont;
+        // --- Binary search and range queries over the ascending order
+        // All of these run in O(log n) on the cached sorted permutation (the first call after a
+        // modification pays one sort). Returned iterators are positioned mid-sequence in ascending
+        // order and can be advanced up to end_ascending_order().
 
-            // A vector to store the indexes of the original elements, sorted according to their values.
-            // This forms the "snapshot" for this specific iterator.
-            std::vector<size_t> indexes;
+        // First element in ascending order that is not less than 'value'.
+        AscendingOrderIterator lower_bound(const T& value) const {
+            auto sorted = sorted_indexes();
+            size_t position = sorted_position(*sorted, [&](const T& e) { return e < value; });
+            return AscendingOrderIterator(*this, std::move(sorted), position);
+        }
 
-            // The current position within the `indexes` vector during iteration.
-            size_t current_index_in_sorted_indexes;
+        // First element in ascending order that is greater than 'value'.
+        AscendingOrderIterator upper_bound(const T& value) const {
+            auto sorted = sorted_indexes();
+            size_t position = sorted_position(*sorted, [&](const T& e) { return !(value < e); });
+            return AscendingOrderIterator(*this, std::move(sorted), position);
+        }
 
-        public:
-            // Constructor for DescendingOrderIterator.
-            // Initializes the iterator by sorting indexes based on the container's elements in descending order.
-            // This constructor performs a sort operation each time it's called.
-            // is_end_iterator_flag: true if this is an end iterator, false for begin.
-            DescendingOrderIterator(const MyContainer<T>& cont, bool is_end_iterator_flag)
-                : cont(cont) {
-
-                // Populate 'indexes' with initial order (0 to size-1)
-                for (size_t i = 0; i < cont.size(); ++i) {
-                    indexes.push_back(i);
-                }
-
-                // Sort 'indexes' based on the values in the container (lambda function).
-                // This lambda captures the container reference and sorts indexes based on the elements.
-                // Sorts in DESCENDING order (a > b)
-                std::sort(indexes.begin(), indexes.end(),
-                    [&](size_t a, size_t b) {
-                        // Ensures sorting is stable and handles equal elements correctly if needed
-                        return cont.getElements()[a] > cont.getElements()[b]; 
-                        //same as it was implemented earlier, changed from < to > for descending order
-                    });
-
-                if (is_end_iterator_flag) { // For end iterator
-                    current_index_in_sorted_indexes = indexes.size();
-                } else { // For begin iterator
-                    current_index_in_sorted_indexes = 0;
-                }
-            }
-
-            //Dereference operator (*it).
-            //Provides access to the element currently pointed to by the iterator.
-            const T& operator*() const {
-                // Ensure the current index is within valid bounds of the sorted indexes.
-                if (current_index_in_sorted_indexes >= indexes.size()) {
-                    throw std::out_of_range("DescendingOrderIterator: Dereference out of bounds."); // Updated message
-                }
-                // Use the current sorted index to access the actual element from the MyContainer.
-                return cont.getElements()[indexes[current_index_in_sorted_indexes]];
-            }
-
-            //Pre-increment operator (++it).
-            //Advances the iterator to the next element in the sorted sequence.
-            DescendingOrderIterator& operator++() {
-                if (current_index_in_sorted_indexes < indexes.size()) {
-                    current_index_in_sorted_indexes++; // Move to the next index in our sorted list
-                } 
-                return *this;
+        // The elements equal to 'value', as [lower_bound(value), upper_bound(value)).
+        std::pair<AscendingOrderIterator, AscendingOrderIterator> equal_range(const T& value) const {
+            return {lower_bound(value), upper_bound(value)};
+        }
+
+        // Number of elements less than 'value'.
+        size_t rank(const T& value) const {
+            return sorted_position(*sorted_indexes(), [&](const T& e) { return e < value; });
+        }
+
+        // Number of elements in the half-open range [lo, hi).
+        size_t count_in_range(const T& lo, const T& hi) const {
+            if (!(lo < hi)) {
+                return 0;
             }
+            return rank(hi) - rank(lo);
+        }
+
+        // The elements in [lo, hi), as an ascending view.
+        OrderView<AscendingOrder> elements_in_range(const T& lo, const T& hi) const {
+            auto sorted = sorted_indexes();
+            size_t first = sorted_position(*sorted, [&](const T& e) { return e < lo; });
+            size_t last = (lo < hi) ? sorted_position(*sorted, [&](const T& e) { return e < hi; }) : first;
+            return OrderView<AscendingOrder>(AscendingOrderIterator(*this, std::move(sorted), first), last);
+        }
 
-            //Post-increment operator (it++).
-            //Advances the iterator to the next element, but returns a copy of the iterator's state
-            // *before* the increment.
-            DescendingOrderIterator operator++(int) {
-                DescendingOrderIterator temp = *this; // Save current state
-                ++(*this); // Increment actual iterator
-                return temp; // Return saved state
+        // --- Order statistics and percentiles
+        // With a cached sorted permutation these are O(1) lookups; otherwise they select with
+        // std::nth_element (introselect) on a copy of the elements, without sorting or caching.
+
+        // The k-th smallest element (k = 0 is the minimum).
+        T nth_element_value(size_t k) const {
+            if (k >= size()) {
+                throw std::out_of_range("MyContainer::nth_element_value: rank out of range.");
+            }
+            if (auto sorted = cached_sorted_indexes()) {
+                return contents()[(*sorted)[k]];
             }
+            std::vector<T> work(contents().begin(), contents().end());
+            std::nth_element(work.begin(), work.begin() + k, work.end());
+            return work[k];
+        }
 
-            //Equality operator (it1 == it2).
-            //Compares two DescendingOrderIterator objects for equality.
-            bool operator==(const DescendingOrderIterator& other) const {
-                // Iterators are equal if their internal index is the same AND they refer to the same container instance.
-                return current_index_in_sorted_indexes == other.current_index_in_sorted_indexes && &cont == &other.cont;
+        // The p-th percentile (0 <= p <= 100) by the nearest-rank method:
+        // the smallest element such that at least p% of the elements are less than or equal to it.
+        T percentile(double p) const {
+            return nth_element_value(percentile_rank(p));
+        }
+
+        // Several percentiles at once, in the order requested. Without a cached permutation the
+        // elements are copied and partitioned once for all requested ranks.
+        std::vector<T> percentiles(const std::vector<double>& ps) const {
+            std::vector<size_t> ranks;
+            ranks.reserve(ps.size());
+            for (double p : ps) {
+                ranks.push_back(percentile_rank(p));
             }
 
-            //Inequality operator (it1 != it2).
-            //Compares two DescendingOrderIterator objects for inequality.
-            bool operator!=(const DescendingOrderIterator& other) const {
-                return !(*this == other);
+            std::vector<T> result;
+            result.reserve(ranks.size());
+            if (auto sorted = cached_sorted_indexes()) {
+                for (size_t k : ranks) {
+                    result.push_back(contents()[(*sorted)[k]]);
+                }
+                return result;
             }
-        };
 
-        // Begin and end methods for DescendingOrderIterator.
-        DescendingOrderIterator begin_descending_order() const {
-            return DescendingOrderIterator(*this, false); // false indicates this is a begin iterator
+            std::vector<size_t> distinct_ranks(ranks);
+            std::sort(distinct_ranks.begin(), distinct_ranks.end());
+            distinct_ranks.erase(std::unique(distinct_ranks.begin(), distinct_ranks.end()), distinct_ranks.end());
+
+            std::vector<T> work(contents().begin(), contents().end());
+            select_ranks(work, 0, work.size(), distinct_ranks.data(), distinct_ranks.data() + distinct_ranks.size());
+            for (size_t k : ranks) {
+                result.push_back(work[k]);
+            }
+            return result;
         }
-        
-        DescendingOrderIterator end_descending_order() const {
-            return DescendingOrderIterator(*this, true); // true indicates this is an end iterator
+
+        // --- Top-k queries
+        // The first k elements of the ascending, descending or side-cross order (all elements if k is
+        // larger), as copies in traversal order, without sorting the whole container: one pass with a
+        // bounded heap of k indexes, O(n log k), and nothing cached. With a cached sorted permutation
+        // they are read from it in O(k). Ties come out exactly as in the full traversals.
+
+        // The k smallest elements, smallest first.
+        std::vector<T> bottom_k(size_t k) const {
+            return sorted_prefix(k, AscendingOrder{});
+        }
+
+        // The k largest elements, largest first.
+        std::vector<T> top_k(size_t k) const {
+            return sorted_prefix(k, DescendingOrder{});
+        }
+
+        // The first k elements of side-cross order: the (k + 1) / 2 smallest and the k / 2 largest,
+        // alternating.
+        std::vector<T> side_cross_prefix(size_t k) const {
+            return sorted_prefix(k, SideCrossOrder{});
         }
 
-        // --- 4. ReverseOrderIterator (Iterates in reverse order of insertion)
-        class ReverseOrderIterator { 
+        // --- Distinct values and frequencies
+        // Ascending traversals with one step per run of equal elements of the sorted permutation
+        // (equal meaning neither is less than the other). Each run's end is found by galloping
+        // (exponential then binary search), so a container with d distinct values is traversed in
+        // O(d log(n / d)) once the permutation is cached. Each step exposes the first element of its
+        // run, i.e. the earliest inserted one. Like the other iterators, they read the snapshot taken
+        // when created and must not outlive the container.
+
+        // One step of frequencies(): the run's first element and its length. It is both the value and
+        // the reference type of the iterator, so frequencies() models std::ranges::forward_range.
+        struct Run {
+            const T& value;
+            size_t count;
+        };
+
+        template <bool WithCount>
+        class RunIterator {
+        public:
+            using iterator_concept = std::forward_iterator_tag;
+            using iterator_category = std::input_iterator_tag;
+            using value_type = std::conditional_t<WithCount, Run, T>;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::conditional_t<WithCount, Run, const T&>;
+
         private:
-            // the iterator holds a valid reference to the parent container,
-            // which remains valid even if the underlying 'elements' vector reallocates.
-            const MyContainer<T>& cont;
-            size_t current_index;
+            const MyContainer* cont = nullptr;
+            std::shared_ptr<const std::vector<size_t>> snapshot;
+            size_t first = 0;  // Position of the run in the sorted permutation
+            size_t last = 0;   // One past its end
+
+            const T& at(size_t position) const {
+                return cont->contents()[(*snapshot)[position]];
+            }
+
+            // End of the run starting at 'first'.
+            size_t run_end() const {
+                const size_t n = snapshot->size();
+                if (first >= n) {
+                    return n;
+                }
+                const T& value = at(first);
+                size_t known_equal = first;
+                size_t step = 1;
+                while (known_equal + step < n && !(value < at(known_equal + step))) {
+                    known_equal += step;
+                    step *= 2;
+                }
+                size_t low = known_equal + 1;
+                size_t high = std::min(known_equal + step, n);
+                while (low < high) {
+                    size_t middle = low + (high - low) / 2;
+                    if (value < at(middle)) {
+                        high = middle;
+                    } else {
+                        low = middle + 1;
+                    }
+                }
+                return low;
+            }
 
         public:
-            // Constructor for ReverseOrderIterator.
-            // Initializes the iterator with a reference to the container and a starting index.
-            ReverseOrderIterator(const MyContainer<T>& c, size_t index) 
-                : cont(c), current_index(index) {}
-            
-            // Dereference operator (*it).
-            // Provides access to the element currently pointed to by the iterator.
-            const T& operator*() const {
-                // Access elements through the container's getElements() method,
-                // ensuring access to the current, valid underlying vector.
-                if (current_index >= cont.size()) {
-                    throw std::out_of_range("ReverseOrderIterator: Dereference out of bounds."); 
+            RunIterator() = default;
+
+            RunIterator(const MyContainer& c, std::shared_ptr<const std::vector<size_t>> s)
+                : cont(&c), snapshot(std::move(s)) {
+                last = run_end();
+            }
+
+            reference operator*() const noexcept(!checked_iterators) {
+                if constexpr (checked_iterators) {
+                    if (first >= snapshot->size()) {
+                        throw std::out_of_range("RunIterator: Dereference out of bounds.");
+                    }
+                }
+                if constexpr (WithCount) {
+                    return Run{at(first), last - first};
+                } else {
+                    return at(first);
                 }
-                return cont.getElements()[current_index];
             }
 
-            // Pre-increment operator (++it).
-            // Advances the iterator to the next element in the container.
-            ReverseOrderIterator& operator++() { 
-                // No bounds check here for increment, as standard iterators can be incremented to 'end'.
-                // Dereference operator handles out-of-bounds access.
-                current_index--; // Changed operation from ++ to --
+            RunIterator& operator++() {
+                first = last;
+                last = run_end();
                 return *this;
             }
-            // Post-increment operator (it++).
-            // Advances the iterator to the next element, but returns a copy of the iterator's state before the increment.
-            ReverseOrderIterator operator++(int) {
-                ReverseOrderIterator temp = *this;
+
+            RunIterator operator++(int) {
+                RunIterator temp = *this;
                 ++(*this);
                 return temp;
             }
 
-            // Equality operator (it1 == it2).
-            // Compares two ReverseOrderIterator objects for equality.
-            bool operator==(const ReverseOrderIterator& other) const { 
-                // Equality check now compares the container references, ensuring both iterators
-                // belong to the same logical container instance.
-                return current_index == other.current_index && &cont == &other.cont;
+            bool operator==(const RunIterator& other) const noexcept {
+                return first == other.first && cont == other.cont;
             }
-            // Inequality operator (it1 != it2).
-            // Compares two ReverseOrderIterator objects for inequality.
-            bool operator!=(const ReverseOrderIterator& other) const { 
-                return !(*this == other);
+
+            bool operator==(std::default_sentinel_t) const noexcept {
+                return !snapshot || first >= snapshot->size();
             }
         };
 
-        // Begin and end methods for ReverseOrderIterator.
-        ReverseOrderIterator begin_reverse_order() const { 
-            // For reverse iteration, begin is the last element.
-            if (elements.empty()) {
-                return ReverseOrderIterator(*this, static_cast<size_t>(-1));// Return an end iterator
-            }
-            return ReverseOrderIterator(*this, elements.size() - 1);
+        // The distinct values in ascending order.
+        std::ranges::subrange<RunIterator<false>, std::default_sentinel_t> distinct_ascending() const {
+            return {RunIterator<false>(*this, sorted_indexes()), std::default_sentinel};
         }
-        
-        ReverseOrderIterator end_reverse_order() const {
-            // The iterator will start from the last element and move backwards.
-            // The iterator will stop exactly when it has moved past the first element.
-            // For reverse iteration, end is conceptually "before" the first element (index [-1]).
-            // Using static_cast<size_t>(-1) is to handle the end of a reverse iteration
-            return ReverseOrderIterator(*this, static_cast<size_t>(-1));
+
+        // (value, count) runs in ascending order of value.
+        std::ranges::subrange<RunIterator<true>, std::default_sentinel_t> frequencies() const {
+            return {RunIterator<true>(*this, sorted_indexes()), std::default_sentinel};
         }
 
-        // --- 5. SideCrossOrderIterator (Iterates in side-cross order: smallest, largest, second-smallest, second-largest, etc.)
-        class SideCrossOrderIterator {
-        private:
-            // A constant reference to the parent MyContainer instance.
-            // This allows the iterator to access the container's elements via getElements().
-            const MyContainer<T>& cont;
-
-            // A vector to store the indexes of the original elements, sorted according to their values.
-            // This forms the "snapshot" for this specific iterator's traversal logic.
-            std::vector<size_t> sorted_original_indexes;
-
-            // Pointers to the current smallest and largest elements in the sorted_original_indexes list.
-            size_t left_ptr_in_sorted_indexes;  // Points to the current smallest remaining element
-            size_t right_ptr_in_sorted_indexes; // Points to the current largest remaining element
-
-            // Flag to determine whether to take the next element from the left (smallest) or right (largest) side.
-            bool is_left_turn;
-
-            // The actual index in the *original* container that the iterator currently points to.
-            // This is what operator* will dereference. For the end iterator, this will be sorted_original_indexes.size().
-            size_t current_returned_original_index;
-            public:
-            // Constructor for SideCrossOrderIterator.
-            // Initializes the iterator by sorting indexes based on the container's elements
-            // and setting up the initial pointers for side-cross traversal.
-            // is_end_iterator_flag: true if this is an end iterator, false for begin.
-            SideCrossOrderIterator(const MyContainer<T>& c, bool is_end_iterator_flag)
-                : cont(c) {
-                // Populate 'sorted_original_indexes' with initial order (0 to size-1)
-                for (size_t i = 0; i < cont.getElements().size(); ++i) {
-                    sorted_original_indexes.push_back(i);
-                }
-
-                // Sort 'sorted_original_indexes' based on the values in the container.
-                // This lambda captures the container reference and sorts indexes based on the elements.
-                std::sort(sorted_original_indexes.begin(), sorted_original_indexes.end(),
-                    [&](size_t a, size_t b) {
-                        return cont.getElements()[a] < cont.getElements()[b];
-                    });
-
-                // Initialize left and right pointers for traversal
-                left_ptr_in_sorted_indexes = 0;
-                right_ptr_in_sorted_indexes = sorted_original_indexes.size() - 1;
-                is_left_turn = true; // Start with the smallest element
-
-                if (is_end_iterator_flag || sorted_original_indexes.empty()) {
-                    // For the end iterator, or an empty container, set the current index to past-the-end.
-                    current_returned_original_index = sorted_original_indexes.size();
-                    // Ensure the bounds are in an "ended" state for consistency.
-                    left_ptr_in_sorted_indexes = sorted_original_indexes.size();
-                    right_ptr_in_sorted_indexes = sorted_original_indexes.size() -1; // Makes left_ptr > right_ptr
-                } else { // For begin iterator on a non-empty container
-                    // Set the initial element to the smallest (first in sorted list)
-                    current_returned_original_index = sorted_original_indexes[left_ptr_in_sorted_indexes];
-                }
-            }
-
-            //Dereference operator (*it).
-            //Provides access to the element currently pointed to by the iterator.
-            const T& operator*() const {
-                // Ensure the current index is within valid bounds of the original container.
-                if (current_returned_original_index >= cont.size()) {
-                    throw std::out_of_range("SideCrossOrderIterator: Dereference out of bounds.");
-                }
-                // Use the stored original index to access the actual element from the MyContainer.
-                return cont.getElements()[current_returned_original_index];
-            }
-            //Pre-increment operator (++it).
-            //Advances the iterator to the next element in the side-cross sequence.
-            SideCrossOrderIterator& operator++() {
-                // If already at the end, do nothing.
-                if (current_returned_original_index == sorted_original_indexes.size()) {
-                    return *this;
-                }
-
-                // Advance pointers based on current turn
-                if (is_left_turn) {
-                    left_ptr_in_sorted_indexes++;
-                    is_left_turn = false;
-                } else {
-                    right_ptr_in_sorted_indexes--;
-                    is_left_turn = true;
+        // The distinct values (by operator==) in order of first appearance, found with a hash set of
+        // element indexes in O(n) expected time, without sorting. Needs std::hash<T>.
+        std::vector<T> distinct_unordered() const
+            requires requires(const T& value) { { std::hash<T>{}(value) } -> std::convertible_to<size_t>; }
+        {
+            const std::span<const T> values = contents();
+            auto hash = [&](size_t i) { return std::hash<T>{}(values[i]); };
+            auto equal = [&](size_t a, size_t b) { return values[a] == values[b]; };
+            std::unordered_set<size_t, decltype(hash), decltype(equal)> seen(values.size() / 4 + 16, hash, equal);
+            std::vector<T> result;
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (seen.insert(i).second) {
+                    result.push_back(values[i]);
                 }
+            }
+            return result;
+        }
 
-                // Update current_returned_original_index based on the new pointer positions
-                if (left_ptr_in_sorted_indexes <= right_ptr_in_sorted_indexes) {
-                    if (is_left_turn) { // Next will be from left side
-                        current_returned_original_index = sorted_original_indexes[left_ptr_in_sorted_indexes];
-                    } else { // Next will be from right side
-                        current_returned_original_index = sorted_original_indexes[right_ptr_in_sorted_indexes];
-                    }
-                } else {
-                    // All elements have been processed, set to end state
-                    current_returned_original_index = sorted_original_indexes.size();
+        // --- Binary serialization
+        // Writes the container in the binary format (see BinaryHeader). With with_sorted_indexes the
+        // sorted permutation is stored too (building it first if needed), so the loaded container is
+        // ready for sorted traversal without a sort. Bulk element types are written with one write().
+        void save(std::ostream& out, bool with_sorted_indexes = false) const {
+            using codec = binary_codec<T>;
+            const std::span<const T> values = contents();
+            BinaryHeader header{};
+            std::memcpy(header.magic, BinaryHeader::expected_magic, sizeof(header.magic));
+            header.version = BinaryHeader::current_version;
+            header.flags = (with_sorted_indexes ? BinaryHeader::has_sorted_indexes : 0) |
+                           (codec::bulk ? BinaryHeader::bulk_elements : 0) |
+                           (std::endian::native == std::endian::big ? BinaryHeader::big_endian : 0);
+            header.element_size = codec::bulk ? static_cast<std::uint32_t>(sizeof(T)) : 0;
+            header.count = values.size();
+            write_binary(out, &header, sizeof(header));
+
+            if constexpr (codec::bulk) {
+                write_binary(out, values.data(), values.size() * sizeof(T));
+                const char padding[8] = {};
+                write_binary(out, padding, (8 - values.size() * sizeof(T) % 8) % 8);
+            } else {
+                for (const T& value : values) {
+                    codec::write(out, value);
                 }
-                
-                return *this;
             }
 
-            //Post-increment operator (it++).
-            //Advances the iterator to the next element, but returns a copy of the iterator's state
-            // *before* the increment.
-            SideCrossOrderIterator operator++(int) {
-                SideCrossOrderIterator temp = *this; // Save current state
-                ++(*this); // Increment actual iterator
-                return temp; // Return saved state
+            if (with_sorted_indexes) {
+                auto sorted = sorted_indexes();
+                if constexpr (sizeof(size_t) == sizeof(std::uint64_t)) {
+                    write_binary(out, sorted->data(), sorted->size() * sizeof(std::uint64_t));
+                } else {
+                    for (size_t index : *sorted) {
+                        std::uint64_t stored = index;
+                        write_binary(out, &stored, sizeof(stored));
+                    }
+                }
             }
+        }
 
-            //Equality operator (it1 == it2).
-            //Compares two SideCrossOrderIterator objects for equality.
-            bool operator==(const SideCrossOrderIterator& other) const {
-                // Iterators are equal if their currently pointed-to original index is the same
-                // AND they refer to the same container instance.
-                return current_returned_original_index == other.current_returned_original_index && &cont == &other.cont;
+        // Reads a container written by save(). A persisted sorted permutation is installed as the cache
+        // after checking that it is a permutation of the element indexes. Throws std::runtime_error for
+        // input that is truncated, not in the binary format, or written for a different element type.
+        static MyContainer<T> load(std::istream& in) {
+            using codec = binary_codec<T>;
+            BinaryHeader header{};
+            read_binary(in, &header, sizeof(header));
+            check_header(header, "MyContainer::load");
+
+            MyContainer<T> result;
+            std::vector<T>& values = result.modifiable_elements();
+            result.current_epoch = 0;
+            const std::uint64_t count = header.count;
+            if constexpr (codec::bulk) {
+                // Read in bounded blocks, so a corrupt count fails at end of input instead of allocating it.
+                constexpr std::uint64_t block = (std::uint64_t{1} << 24) / sizeof(T) + 1;
+                for (std::uint64_t done = 0; done < count;) {
+                    size_t part = static_cast<size_t>(std::min(block, count - done));
+                    values.resize(values.size() + part);
+                    read_binary(in, values.data() + done, part * sizeof(T));
+                    done += part;
+                }
+                char padding[8];
+                read_binary(in, padding, (8 - count * sizeof(T) % 8) % 8);
+            } else {
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    values.push_back(codec::read(in));
+                }
             }
 
-            //Inequality operator (it1 != it2).
-            //Compares two SideCrossOrderIterator objects for inequality.
-            bool operator!=(const SideCrossOrderIterator& other) const {
-                return !(*this == other);
+            if (header.flags & BinaryHeader::has_sorted_indexes) {
+                std::vector<std::uint64_t> stored(values.size());
+                read_binary(in, stored.data(), stored.size() * sizeof(std::uint64_t));
+                result.set_sorted_cache(checked_permutation(stored.data(), stored.size(), "MyContainer::load"));
             }
-        };
-
-        // Begin and end methods for SideCrossOrderIterator.
-        SideCrossOrderIterator begin_side_cross_order() const {
-            return SideCrossOrderIterator(*this, false); // false indicates this is a begin iterator
+            result.refresh_contents();
+            return result;
         }
 
-        SideCrossOrderIterator end_side_cross_order() const {
-            return SideCrossOrderIterator(*this, true); // true indicates this is an end iterator
+        // Writes the binary format to the file at 'path' (the writer for map()).
+        void save(const std::string& path, bool with_sorted_indexes = false) const {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                throw std::runtime_error("MyContainer::save: cannot open " + path);
+            }
+            save(out, with_sorted_indexes);
+            out.close();
+            if (!out) {
+                throw std::runtime_error("MyContainer::save: write failed for " + path);
+            }
         }
 
-        // --- 6. MiddleOutOrderIterator (Iterates from the middle element outwards, alternating left and right) 
-        class MiddleOutOrderIterator {
-        private:
-            // A constant reference to the parent MyContainer instance.
-            // This allows the iterator to access the container's elements via getElements().
-            const MyContainer<T>& cont;
+        // Reads the file at 'path' onto the heap; see map() for reading it in place.
+        static MyContainer<T> load(const std::string& path) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                throw std::runtime_error("MyContainer::load: cannot open " + path);
+            }
+            return load(in);
+        }
 
-            // A vector to store the indexes of the original elements, arranged in middle-out order.
-            // This forms the "snapshot" of the traversal path for this specific iterator.
-            std::vector<size_t> arranged_original_indexes;
+        // --- Memory-mapped containers
+        // Returns a container whose elements are read in place from the file at 'path', written by
+        // save() for the same (trivially copyable) T. The file is mapped read-only and shared through
+        // the page cache, so processes mapping the same file share its memory and nothing is copied to
+        // the heap; pages are read on first access. Every traversal order, view, query, snapshot() and
+        // copy works on it (copies share the mapping). A persisted sorted permutation is checked and
+        // copied into the sorted cache. The container stays usable after modification: the first
+        // addElement/removeElement copies the elements onto the heap and drops the mapping.
+        // getElements() is not available while mapped; use contents().
+        static MyContainer<T> map(const std::string& path) {
+            static_assert(binary_codec<T>::bulk, "MyContainer::map needs a trivially copyable element type.");
+            auto file = std::make_shared<const MappedFile>(path);
+            BinaryHeader header{};
+            if (file->size() < sizeof(header)) {
+                throw std::runtime_error("MyContainer::map: " + path + " is too small to be a MyContainer file.");
+            }
+            std::memcpy(&header, file->data(), sizeof(header));
+            check_header(header, "MyContainer::map");
+
+            const size_t available = file->size() - sizeof(header);
+            const bool has_sorted = (header.flags & BinaryHeader::has_sorted_indexes) != 0;
+            const size_t per_element = sizeof(T) + (has_sorted ? sizeof(std::uint64_t) : 0);
+            if (header.count > available / per_element) {
+                throw std::runtime_error("MyContainer::map: " + path + " is truncated.");
+            }
+            const size_t count = static_cast<size_t>(header.count);
+            const size_t element_bytes = count * sizeof(T) + (8 - count * sizeof(T) % 8) % 8;
+            if (element_bytes + (has_sorted ? count * sizeof(std::uint64_t) : 0) > available) {
+                throw std::runtime_error("MyContainer::map: " + path + " is truncated.");
+            }
+            const std::byte* first = file->data() + sizeof(header);
+            static_assert(alignof(T) <= 8, "Mapped elements are only guaranteed 8-byte alignment.");
+
+            MyContainer<T> result;
+            result.current = std::span<const T>(reinterpret_cast<const T*>(first), count);
+            if (has_sorted) {
+                const auto* stored = reinterpret_cast<const std::uint64_t*>(first + element_bytes);
+                result.set_sorted_cache(checked_permutation(stored, count, "MyContainer::map"));
+            }
+            result.mapping = std::move(file);
+            return result;
+        }
 
-            // The current position within the `arranged_original_indexes` vector during iteration.
-            size_t current_index_in_arranged_indexes;
-        public:
-            // Constructor for MiddleOutOrderIterator.
-            // Initializes the iterator by arranging the original indexes in middle-out order.
-            // This constructor performs the arrangement operation each time it's called.
-            // is_end_iterator_flag: true if this is an end iterator, false for begin.
-            MiddleOutOrderIterator(const MyContainer<T>& c, bool is_end_iterator_flag)
-                : cont(c) {
-                
-                size_t n = cont.getElements().size();
-
-                if (n == 0) {
-                    // For an empty container, the arranged_original_indexes remains empty.
-                    current_index_in_arranged_indexes = 0; // Or any value that equals arranged_original_indexes.size() (which is 0)
+        // --- Text ingestion
+        // Builds a container from text holding one number per field, with fields separated by
+        // 'delimiter' or by newlines (e.g. one value per line, or comma-separated lines). Spaces, tabs
+        // and '\r' around a value (unless one of them is the delimiter) and empty fields are ignored. The input is read in large blocks and
+        // parsed in place with std::from_chars; when the input size is known, storage is reserved once
+        // from the value density of the first block. With read_ahead, a second thread reads the next
+        // blocks while the current one is parsed. T must be an integer or floating-point type.
+        // Throws std::runtime_error for a field that is not a valid value of T (or out of its range).
+        static MyContainer<T> load_text(std::istream& in, char delimiter = '\n', bool read_ahead = false) {
+            static_assert(to_chars_formattable, "MyContainer::load_text needs an integer or floating-point T.");
+            constexpr size_t block_size = size_t{1} << 20;
+
+            // Bytes left in the input, if the stream can tell; used for the reserve estimate.
+            size_t input_size = 0;
+            const std::streampos start = in.tellg();
+            if (start != std::streampos(-1) && in.seekg(0, std::ios::end)) {
+                input_size = static_cast<size_t>(in.tellg() - start);
+                in.seekg(start);
+            }
+            in.clear();
+
+            auto read_block = [&in](std::string& block) {
+                block.resize(block_size);
+                in.read(block.data(), static_cast<std::streamsize>(block_size));
+                block.resize(static_cast<size_t>(in.gcount()));
+                if (in.bad()) {
+                    throw std::runtime_error("MyContainer::load_text: read failed.");
+                }
+                return !block.empty();
+            };
+
+            MyContainer<T> result;
+            std::vector<T>& values = result.modifiable_elements();
+            result.current_epoch = 0;
+            std::string carry;  // An incomplete field at the end of the previous block.
+            bool first_block = true;
+            auto parse_block = [&](const std::string& block) {
+                const char* first = block.data();
+                const char* last = first + block.size();
+                const char* boundary = last;
+                while (boundary != first && boundary[-1] != delimiter && boundary[-1] != '\n') {
+                    --boundary;
+                }
+                if (boundary == first) {
+                    carry.append(first, last);
                     return;
                 }
+                // Complete the carried field with the head of this block, then parse up to the last separator.
+                const char* head_end = first;
+                while (*head_end != delimiter && *head_end != '\n') {
+                    ++head_end;
+                }
+                carry.append(first, head_end + 1);
+                parse_text(carry.data(), carry.data() + carry.size(), delimiter, values);
+                parse_text(head_end + 1, boundary, delimiter, values);
+                carry.assign(boundary, last);
+                if (first_block && input_size > block.size() && !values.empty()) {
+                    values.reserve(static_cast<size_t>(static_cast<double>(input_size) / static_cast<double>(block.size()) *
+                                                       static_cast<double>(values.size()) * 1.05));
+                }
+                first_block = false;
+            };
 
-                // Calculate the middle index (or indices for even count).
-                // using floor division for the middle index, which rounds down.
-                // For [odd-sized] (e.g size 5), middle_index_base = (5-1)/2 = index 2.
-                // For [even-sized] (e.g size 4), middle_index_base = (4-1)/2 = index 1.
-                int middle_index_base = (n - 1) / 2;
-
-                // Add the middle element first
-                arranged_original_indexes.push_back(middle_index_base);
+            if (!read_ahead) {
+                std::string block;
+                while (read_block(block)) {
+                    parse_block(block);
+                }
+            } else {
+                // Bounded hand-off of filled blocks from the reader thread to this (parsing) thread.
+                struct BlockQueue {
+                    std::mutex mutex;
+                    std::condition_variable changed;
+                    std::deque<std::string> blocks;
+                    bool finished = false;   // Reader reached the end (or failed).
+                    bool cancelled = false;  // Parser failed; the reader should stop.
+                    std::exception_ptr error;
+                } queue;
+                constexpr size_t max_queued = 4;
+
+                std::thread reader([&] {
+                    try {
+                        std::string block;
+                        while (read_block(block)) {
+                            std::unique_lock<std::mutex> lock(queue.mutex);
+                            queue.changed.wait(lock, [&] { return queue.cancelled || queue.blocks.size() < max_queued; });
+                            if (queue.cancelled) {
+                                break;
+                            }
+                            queue.blocks.push_back(std::move(block));
+                            queue.changed.notify_all();
+                        }
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(queue.mutex);
+                        queue.error = std::current_exception();
+                    }
+                    std::lock_guard<std::mutex> lock(queue.mutex);
+                    queue.finished = true;
+                    queue.changed.notify_all();
+                });
+
+                try {
+                    for (;;) {
+                        std::string block;
+                        {
+                            std::unique_lock<std::mutex> lock(queue.mutex);
+                            queue.changed.wait(lock, [&] { return queue.finished || !queue.blocks.empty(); });
+                            if (queue.blocks.empty()) {
+                                break;
+                            }
+                            block = std::move(queue.blocks.front());
+                            queue.blocks.pop_front();
+                            queue.changed.notify_all();
+                        }
+                        parse_block(block);
+                    }
+                } catch (...) {
+                    {
+                        std::lock_guard<std::mutex> lock(queue.mutex);
+                        queue.cancelled = true;
+                        queue.changed.notify_all();
+                    }
+                    reader.join();
+                    throw;
+                }
+                reader.join();
+                if (queue.error) {
+                    std::rethrow_exception(queue.error);
+                }
+            }
+            parse_text(carry.data(), carry.data() + carry.size(), delimiter, values);
+            result.refresh_contents();
+            return result;
+        }
 
-                // Pointers for outward expansion
-                int left_offset = 1;  // Distance to the left from middle_index_base
-                int right_offset = 1; // Distance to the right from middle_index_base
-                bool use_left = true; // Flag to alternate between left and right
+        static MyContainer<T> load_text(const std::string& path, char delimiter = '\n', bool read_ahead = false) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                throw std::runtime_error("MyContainer::load_text: cannot open " + path);
+            }
+            return load_text(in, delimiter, read_ahead);
+        }
 
-                // Continue adding elements until all are included
-                while (arranged_original_indexes.size() < n) {
-                    if (use_left) {
-                        int left_index = middle_index_base - left_offset;
-                        if (left_index >= 0) { // Check if left index is valid
-                            arranged_original_indexes.push_back(left_index);
+        // --- Fast printing
+        // Writes "MyContainer elements: [a, b, ...]" with the elements in 'order' (operator<< prints
+        // insertion order). The text is assembled in a char buffer and handed to the stream in bulk
+        // writes of about chunk_size bytes, so huge containers stream out in bounded memory.
+        // Integers and floating-point values are formatted with std::to_chars while the stream uses
+        // default number formatting (no base/float/sign flags, classic locale), which produces the same
+        // text as inserting each value; other types and customized streams go through operator<<.
+        template <typename Policy>
+        void print(std::ostream& os, Policy order, size_t chunk_size = size_t{1} << 16) const {
+            os << "MyContainer elements: [";
+            const std::span<const T> values = contents();
+            const auto snapshot = order.take_snapshot(*this);
+            const bool fast_numbers = default_number_format(os);
+            std::string buffer;
+            buffer.reserve(chunk_size + 64);
+            auto flush = [&] {
+                os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            };
+
+            size_t cursor = Policy::begin_cursor(*this);
+            for (size_t position = 0; position < values.size(); ++position) {
+                if (position != 0) {
+                    buffer += ", ";
+                }
+                const T& value = values[Policy::index(snapshot, cursor)];
+                cursor = Policy::next(snapshot, cursor);
+                if constexpr (to_chars_formattable) {
+                    if (fast_numbers) {
+                        char digits[64];
+                        std::to_chars_result result;
+                        if constexpr (std::is_floating_point_v<T>) {
+                            result = std::to_chars(digits, digits + sizeof(digits), value,
+                                                   std::chars_format::general, static_cast<int>(os.precision()));
+                        } else {
+                            result = std::to_chars(digits, digits + sizeof(digits), value);
                         }
-                        left_offset++;
+                        buffer.append(digits, result.ptr);
                     } else {
-                        int right_index = middle_index_base + right_offset;
-                        if (right_index < n) { // Check if right index is valid
-                            arranged_original_indexes.push_back(right_index);
-                        }
-                        right_offset++;
+                        flush();
+                        os << value;
                     }
-                    use_left = !use_left; // Toggle for next iteration
+                } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                    buffer += std::string_view(value);
+                } else {
+                    flush();
+                    os << value;
+                }
+                if (buffer.size() >= chunk_size) {
+                    flush();
                 }
+            }
+            buffer += ']';
+            flush();
+        }
 
-                // Set current_index_in_arranged_indexes based on whether it's a begin or end iterator
-                if (is_end_iterator_flag) {
-                    current_index_in_arranged_indexes = arranged_original_indexes.size();
-                } else {
-                    current_index_in_arranged_indexes = 0;
+        // --- Sorted index sidecar
+        // Writes the sorted permutation (building it first if needed) to its own file, with the element
+        // count and a checksum of the elements, e.g. next to a data file as path + ".idx".
+        void save_sorted_index(const std::string& path) const {
+            auto sorted = sorted_indexes();
+            SortedIndexHeader header{};
+            std::memcpy(header.magic, SortedIndexHeader::expected_magic, sizeof(header.magic));
+            header.version = SortedIndexHeader::current_version;
+            header.flags = std::endian::native == std::endian::big ? SortedIndexHeader::big_endian : 0;
+            header.count = sorted->size();
+            header.checksum = contents_checksum();
+
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                throw std::runtime_error("MyContainer::save_sorted_index: cannot open " + path);
+            }
+            write_binary(out, &header, sizeof(header));
+            std::vector<std::uint64_t> stored(sorted->begin(), sorted->end());
+            write_binary(out, stored.data(), stored.size() * sizeof(std::uint64_t));
+            out.close();
+            if (!out) {
+                throw std::runtime_error("MyContainer::save_sorted_index: write failed for " + path);
+            }
+        }
+
+        // Installs the permutation of a sidecar written by save_sorted_index() as the sorted cache, so
+        // ascending, descending and side-cross traversal start without sorting. Returns false, leaving
+        // the cache alone, if the file does not exist or was written for other contents (different
+        // count or checksum). Throws std::runtime_error if the file is not a valid sidecar.
+        // Costs one pass over the elements (checksum) and one over the permutation (validation).
+        bool load_sorted_index(const std::string& path) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                return false;
+            }
+            SortedIndexHeader header{};
+            read_binary(in, &header, sizeof(header));
+            if (std::memcmp(header.magic, SortedIndexHeader::expected_magic, sizeof(header.magic)) != 0 ||
+                header.version != SortedIndexHeader::current_version) {
+                throw std::runtime_error("MyContainer::load_sorted_index: " + path + " is not a sorted index file.");
+            }
+            if (((header.flags & SortedIndexHeader::big_endian) != 0) != (std::endian::native == std::endian::big)) {
+                throw std::runtime_error("MyContainer::load_sorted_index: file was written with a different byte order.");
+            }
+            if (header.count != size() || header.checksum != contents_checksum()) {
+                return false;
+            }
+            std::vector<std::uint64_t> stored(size());
+            read_binary(in, stored.data(), stored.size() * sizeof(std::uint64_t));
+            set_sorted_cache(checked_permutation(stored.data(), stored.size(), "MyContainer::load_sorted_index"));
+            return true;
+        }
+
+    private:
+        // Element types printed with std::to_chars (char types and bool print differently with operator<<).
+        static constexpr bool to_chars_formattable =
+            std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> &&
+            !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char> && !std::is_same_v<T, wchar_t> &&
+            !std::is_same_v<T, char8_t> && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
+        // True if 'os' formats numbers exactly like std::to_chars (decimal, %g-style floats, no locale).
+        static bool default_number_format(const std::ostream& os) {
+            constexpr auto customizing = std::ios_base::basefield | std::ios_base::floatfield |
+                                         std::ios_base::showpos | std::ios_base::showpoint |
+                                         std::ios_base::showbase | std::ios_base::uppercase;
+            return (os.flags() & customizing) == std::ios_base::dec && os.getloc() == std::locale::classic();
+        }
+
+        // Spaces, tabs and '\r' around a value, unless the character is itself the delimiter.
+        static bool is_blank(char c, char delimiter) noexcept {
+            return c != delimiter && (c == ' ' || c == '\t' || c == '\r');
+        }
+
+        // Parses the fields in [first, last) into 'out'. The range must end at a field boundary.
+        static void parse_text(const char* first, const char* last, char delimiter, std::vector<T>& out) {
+            auto is_separator = [delimiter](char c) { return c == delimiter || c == '\n'; };
+            while (first != last) {
+                while (first != last && is_blank(*first, delimiter)) {
+                    ++first;
+                }
+                if (first == last) {
+                    break;
+                }
+                if (is_separator(*first)) {
+                    ++first; // Empty field
+                    continue;
+                }
+                const char* field = first;
+                if (*first == '+' && first + 1 != last && first[1] != '-') {
+                    ++first; // from_chars does not accept an explicit plus sign.
+                }
+                T value{};
+                auto [end, error] = std::from_chars(first, last, value);
+                first = end;
+                while (first != last && is_blank(*first, delimiter)) {
+                    ++first;
+                }
+                if (error != std::errc() || (first != last && !is_separator(*first))) {
+                    const char* field_end = field;
+                    while (field_end != last && !is_separator(*field_end) && field_end - field < 40) {
+                        ++field_end;
+                    }
+                    throw std::runtime_error("MyContainer::load_text: invalid value '" + std::string(field, field_end) + "'.");
+                }
+                out.push_back(value);
+                if (first != last) {
+                    ++first;
                 }
             }
-            
-            // Dereference operator (*it).
-            // Provides access to the element currently pointed to by the iterator.
-            const T& operator*() const {
-                // Ensure the current index is within valid bounds of the arranged indexes.
-                if (current_index_in_arranged_indexes >= arranged_original_indexes.size()) {
-                    throw std::out_of_range("MiddleOutOrderIterator: Dereference out of bounds.");
+        }
+
+        // Checksum of the elements in their binary encoding: the raw bytes for bulk types, the
+        // binary_codec<T> encoding otherwise.
+        std::uint64_t contents_checksum() const {
+            using codec = binary_codec<T>;
+            Checksum sum;
+            if constexpr (codec::bulk) {
+                sum.update(contents().data(), contents().size() * sizeof(T));
+            } else {
+                ChecksumStreamBuffer buffer(sum);
+                std::ostream out(&buffer);
+                for (const T& value : contents()) {
+                    codec::write(out, value);
                 }
-                // Use the current arranged index to access the actual element from the MyContainer.
-                return cont.getElements()[arranged_original_indexes[current_index_in_arranged_indexes]];
             }
+            return sum.value();
+        }
 
-            // Pre-increment operator (++it).
-            // Advances the iterator to the next element in the middle-out sequence.
-            MiddleOutOrderIterator& operator++() {
-                if (current_index_in_arranged_indexes < arranged_original_indexes.size()) {
-                    current_index_in_arranged_indexes++; // Move to the next index in our arranged list
-                } 
-                return *this;
+        // Validates a BinaryHeader against this element type; 'where' prefixes the error messages.
+        static void check_header(const BinaryHeader& header, const std::string& where) {
+            using codec = binary_codec<T>;
+            if (std::memcmp(header.magic, BinaryHeader::expected_magic, sizeof(header.magic)) != 0) {
+                throw std::runtime_error(where + ": not a MyContainer binary file.");
+            }
+            if (header.version != BinaryHeader::current_version) {
+                throw std::runtime_error(where + ": unsupported format version.");
+            }
+            if (((header.flags & BinaryHeader::big_endian) != 0) != (std::endian::native == std::endian::big)) {
+                throw std::runtime_error(where + ": file was written with a different byte order.");
+            }
+            if (((header.flags & BinaryHeader::bulk_elements) != 0) != codec::bulk ||
+                header.element_size != (codec::bulk ? sizeof(T) : 0)) {
+                throw std::runtime_error(where + ": file was written for a different element type.");
             }
+        }
 
-            // Post-increment operator (it++).
-            // Advances the iterator to the next element, but returns a copy of the iterator's state
-            // *before* the increment.
-            MiddleOutOrderIterator operator++(int) {
-                MiddleOutOrderIterator temp = *this; // Save current state
-                ++(*this); // Increment actual iterator
-                return temp; // Return saved state
+        // Converts stored 64-bit indexes to a sorted permutation, checking that they are a permutation
+        // of 0..count-1 so that a corrupt file can never make an iterator read out of bounds.
+        static std::shared_ptr<const std::vector<size_t>> checked_permutation(const std::uint64_t* stored, size_t count,
+                                                                              const std::string& where) {
+            std::vector<size_t> sorted(count);
+            std::vector<bool> seen(count, false);
+            for (size_t i = 0; i < count; ++i) {
+                if (stored[i] >= count || seen[stored[i]]) {
+                    throw std::runtime_error(where + ": corrupt sorted permutation.");
+                }
+                seen[stored[i]] = true;
+                sorted[i] = static_cast<size_t>(stored[i]);
             }
+            return std::make_shared<const std::vector<size_t>>(std::move(sorted));
+        }
 
-            // Equality operator (it1 == it2).
-            // Compares two MiddleOutOrderIterator objects for equality.
-            bool operator==(const MiddleOutOrderIterator& other) const {
-                // Iterators are equal if their internal index is the same AND they refer to the same container instance.
-                return current_index_in_arranged_indexes == other.current_index_in_arranged_indexes && &cont == &other.cont;
+        // Shared body of bottom_k, top_k and side_cross_prefix.
+        template <typename Policy>
+        std::vector<T> sorted_prefix(size_t k, Policy) const {
+            const std::span<const T> values = contents();
+            const size_t count = std::min(k, values.size());
+            std::vector<T> result;
+            result.reserve(count);
+            if (auto sorted = cached_sorted_indexes()) {
+                for (size_t cursor = 0; cursor < count; ++cursor) {
+                    result.push_back(values[Policy::index(sorted, cursor)]);
+                }
+                return result;
+            }
+            if (count == 0) {
+                return result;
             }
+            // Side-cross takes (count + 1) / 2 elements from the left end and count / 2 from the right.
+            const size_t from_left = std::is_same_v<Policy, AscendingOrder> ? count
+                                   : std::is_same_v<Policy, DescendingOrder> ? 0 : (count + 1) / 2;
+            IncrementalSelector<T> left(values, std::max<size_t>(from_left, 1), false);
+            IncrementalSelector<T> right(values, std::max<size_t>(count - from_left, 1), true);
+            for (size_t cursor = 0; cursor < count; ++cursor) {
+                const bool take_left = std::is_same_v<Policy, SideCrossOrder> ? cursor % 2 == 0 : from_left > 0;
+                result.push_back(values[take_left ? left.next() : right.next()]);
+            }
+            return result;
+        }
 
-            // Inequality operator (it1 != it2).
-            // Compares two MiddleOutOrderIterator objects for inequality.
-            bool operator!=(const MiddleOutOrderIterator& other) const {
-                return !(*this == other);
+        // Converts a percentile to a 0-based nearest rank, validating the input.
+        size_t percentile_rank(double p) const {
+            if (size() == 0) {
+                throw std::out_of_range("MyContainer::percentile: container is empty.");
             }
-        };
+            if (!(p >= 0.0 && p <= 100.0)) { // Also rejects NaN
+                throw std::out_of_range("MyContainer::percentile: percentile must be in [0, 100].");
+            }
+            size_t n = size();
+            auto rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(n)));
+            return rank == 0 ? 0 : std::min(rank, n) - 1;
+        }
 
-        // Begin and end methods for MiddleOutOrderIterator.
-        MiddleOutOrderIterator begin_middle_out_order() const {
-            return MiddleOutOrderIterator(*this, false); // false indicates this is a begin iterator
+        // Multi-select: places the element of every rank in [first_rank, last_rank) (sorted, all within
+        // [lo, hi)) at its sorted position by partitioning around the middle rank and recursing.
+        static void select_ranks(std::vector<T>& work, size_t lo, size_t hi,
+                                 const size_t* first_rank, const size_t* last_rank) {
+            while (first_rank != last_rank) {
+                const size_t* middle = first_rank + (last_rank - first_rank) / 2;
+                std::nth_element(work.begin() + lo, work.begin() + *middle, work.begin() + hi);
+                select_ranks(work, lo, *middle, first_rank, middle);
+                lo = *middle + 1;
+                first_rank = middle + 1;
+            }
         }
 
-        MiddleOutOrderIterator end_middle_out_order() const {
-            return MiddleOutOrderIterator(*this, true); // true indicates this is an end iterator
+        // Position in the sorted permutation of the first element for which 'before' is false.
+        // 'before' must be true for a prefix of the ascending order and false for the rest.
+        template <typename Predicate>
+        size_t sorted_position(const std::vector<size_t>& sorted, Predicate before) const {
+            const std::span<const T> values = contents();
+            auto it = std::partition_point(sorted.begin(), sorted.end(),
+                [&](size_t index) { return before(values[index]); });
+            return static_cast<size_t>(it - sorted.begin());
         }
-        
+
+    public:
         // Global operator<< for MyContainer for easy printing.
         friend std::ostream& operator<<(std::ostream& os, const MyContainer<T>& container) {
-            os << "MyContainer elements: [";
-            for (size_t i = 0; i < container.elements.size(); ++i) {
-                os << container.elements[i];
-                if (i < container.elements.size() - 1) {
-                    os << ", ";
-                }
-            }
-            os << "]";
+            container.print(os, insertion);
             return os;
         }
     };//end of MyContainer class
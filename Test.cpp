@@ -6,7 +6,26 @@
 #include <algorithm>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <ranges>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <utility>
+#include <csignal>
+#include <sys/resource.h> // For setrlimit (failing run writes)
 #include "MyContainer.hpp"
+#include "ConcurrentMyContainer.hpp"
+#include "IngestBuffer.hpp"
+#include "WorkStealingPool.hpp"
+#include "ExternalSort.hpp"
+#include "CompressedContainer.hpp"
+#include "DictionaryContainer.hpp"
 using namespace Container;
 TEST_CASE("MyContainer basic operations") {
 
@@ -1773,3 +1792,2030 @@ TEST_CASE("MiddleOutOrderIterator operations") {
         CHECK(it1 == it2); // Both are at their respective end positions
     }
 }
+
+TEST_CASE("Iterator bounds-checking policy") {
+    MyContainer<int> container;
+    container.addElement(3);
+    container.addElement(1);
+    container.addElement(2);
+
+    SUBCASE("Test builds use checked iterators") {
+        // The unit tests rely on std::out_of_range, so they must be built in checked mode.
+        CHECK(checked_iterators);
+    }
+
+    SUBCASE("operator* is noexcept exactly when iterators are unchecked") {
+        // Only the dereference is tested: begin_order() and friends are never noexcept themselves.
+        CHECK(noexcept(*std::declval<const MyContainer<int>::OrderIterator&>()) == !checked_iterators);
+        CHECK(noexcept(*std::declval<const MyContainer<int>::AscendingOrderIterator&>()) == !checked_iterators);
+        CHECK(noexcept(*std::declval<const MyContainer<int>::DescendingOrderIterator&>()) == !checked_iterators);
+        CHECK(noexcept(*std::declval<const MyContainer<int>::ReverseOrderIterator&>()) == !checked_iterators);
+        CHECK(noexcept(*std::declval<const MyContainer<int>::SideCrossOrderIterator&>()) == !checked_iterators);
+        CHECK(noexcept(*std::declval<const MyContainer<int>::MiddleOutOrderIterator&>()) == !checked_iterators);
+    }
+}
+
+TEST_CASE("OrderedIterator policy-based API") {
+    MyContainer<int> container;
+    container.addElement(7);
+    container.addElement(15);
+    container.addElement(6);
+    container.addElement(1);
+    container.addElement(2);
+
+    SUBCASE("begin(order)/end(order) match the named begin/end methods") {
+        std::vector<int> by_tag;
+        for (auto it = container.begin(side_cross); it != container.end(side_cross); ++it) {
+            by_tag.push_back(*it);
+        }
+        CHECK(by_tag == std::vector<int>{1, 15, 2, 7, 6});
+
+        CHECK(container.begin(insertion) == container.begin_order());
+        CHECK(container.end(reverse) == container.end_reverse_order());
+        CHECK(*container.begin(descending) == 15);
+        CHECK(*container.begin(middle_out) == 6);
+    }
+
+    SUBCASE("Named iterator types are instantiations of OrderedIterator") {
+        CHECK(std::is_same<MyContainer<int>::AscendingOrderIterator,
+                           MyContainer<int>::OrderedIterator<AscendingOrder>>::value);
+        CHECK(std::is_same<decltype(container.begin(middle_out)),
+                           MyContainer<int>::MiddleOutOrderIterator>::value);
+    }
+
+    SUBCASE("Iterators are copy-assignable and copies share the snapshot") {
+        MyContainer<int>::AscendingOrderIterator it = container.begin_ascending_order();
+        MyContainer<int>::AscendingOrderIterator prev = it++;
+        prev = it++; // Assignment is now supported
+        CHECK(*prev == 2);
+        CHECK(*it == 6);
+    }
+
+    SUBCASE("Middle-out positions match the outward expansion for every size") {
+        for (int n = 1; n <= 12; ++n) {
+            MyContainer<int> c;
+            for (int i = 0; i < n; ++i) {
+                c.addElement(i); // Value equals original index
+            }
+
+            // Reference arrangement: middle, then alternating left/right, skipping invalid sides.
+            std::vector<int> expected;
+            int middle = (n - 1) / 2;
+            expected.push_back(middle);
+            for (int offset = 1; static_cast<int>(expected.size()) < n; ++offset) {
+                if (middle - offset >= 0) expected.push_back(middle - offset);
+                if (middle + offset < n) expected.push_back(middle + offset);
+            }
+
+            std::vector<int> actual;
+            for (auto it = c.begin_middle_out_order(); it != c.end_middle_out_order(); ++it) {
+                actual.push_back(*it);
+            }
+            CHECK(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("Ranges views over traversal orders") {
+    MyContainer<int> container;
+    container.addElement(7);
+    container.addElement(15);
+    container.addElement(6);
+    container.addElement(1);
+    container.addElement(2);
+
+    using AscendingView = MyContainer<int>::OrderView<AscendingOrder>;
+    static_assert(std::ranges::view<AscendingView>);
+    static_assert(std::ranges::forward_range<AscendingView>);
+    static_assert(std::ranges::sized_range<AscendingView>);
+    static_assert(std::sized_sentinel_for<MyContainer<int>::OrderedSentinel<AscendingOrder>,
+                                          MyContainer<int>::AscendingOrderIterator>);
+    static_assert(std::forward_iterator<MyContainer<int>::ReverseOrderIterator>);
+
+    auto collect = [](auto&& range) {
+        std::vector<int> out;
+        for (int value : range) {
+            out.push_back(value);
+        }
+        return out;
+    };
+
+    SUBCASE("Each order's view yields the same sequence as its iterators") {
+        CHECK(collect(container.view(insertion)) == std::vector<int>{7, 15, 6, 1, 2});
+        CHECK(collect(container.view(ascending)) == std::vector<int>{1, 2, 6, 7, 15});
+        CHECK(collect(container.view(descending)) == std::vector<int>{15, 7, 6, 2, 1});
+        CHECK(collect(container.view(reverse)) == std::vector<int>{2, 1, 6, 15, 7});
+        CHECK(collect(container.view(side_cross)) == std::vector<int>{1, 15, 2, 7, 6});
+        CHECK(collect(container.view(middle_out)) == std::vector<int>{6, 15, 1, 7, 2});
+    }
+
+    SUBCASE("Views are sized") {
+        CHECK(container.view(ascending).size() == 5);
+        CHECK(container.view(reverse).size() == 5);
+        CHECK(std::ranges::size(container.view(middle_out)) == 5);
+        CHECK(std::ranges::distance(container.view(side_cross)) == 5);
+
+        MyContainer<int> empty;
+        CHECK(empty.view(reverse).size() == 0);
+        CHECK(empty.view(ascending).empty());
+    }
+
+    SUBCASE("Views compose with standard range adaptors") {
+        auto smallest_two = container.view(ascending) | std::views::take(2);
+        CHECK(collect(smallest_two) == std::vector<int>{1, 2});
+
+        auto odd_side_cross = container.view(side_cross)
+                            | std::views::filter([](int x) { return x % 2 != 0; });
+        CHECK(collect(odd_side_cross) == std::vector<int>{1, 15, 7});
+    }
+
+    SUBCASE("The container is a range in insertion order") {
+        CHECK(collect(container) == std::vector<int>{7, 15, 6, 1, 2});
+    }
+}
+
+TEST_CASE("Streaming traversal with coroutine generators") {
+    MyContainer<int> container;
+    for (int value : {7, 15, 6, 1, 2, 6, 9, 15, 0, 4, 6}) { // Includes duplicates
+        container.addElement(value);
+    }
+
+    auto flatten = [](Generator<std::vector<int>> batches, std::vector<size_t>* sizes = nullptr) {
+        std::vector<int> out;
+        for (const std::vector<int>& batch : batches) {
+            if (sizes) sizes->push_back(batch.size());
+            out.insert(out.end(), batch.begin(), batch.end());
+        }
+        return out;
+    };
+    auto collect = [](auto&& range) {
+        std::vector<int> out;
+        for (int value : range) out.push_back(value);
+        return out;
+    };
+
+    static_assert(std::ranges::input_range<Generator<std::vector<int>>>);
+
+    SUBCASE("Every order streams the same sequence as its iterators, for any batch size") {
+        for (size_t batch : {1, 2, 3, 4, 11, 50}) {
+            CHECK(flatten(container.stream(insertion, batch)) == collect(container.view(insertion)));
+            CHECK(flatten(container.stream(reverse, batch)) == collect(container.view(reverse)));
+            CHECK(flatten(container.stream(middle_out, batch)) == collect(container.view(middle_out)));
+            CHECK(flatten(container.stream(ascending, batch)) == collect(container.view(ascending)));
+            CHECK(flatten(container.stream(descending, batch)) == collect(container.view(descending)));
+            CHECK(flatten(container.stream(side_cross, batch)) == collect(container.view(side_cross)));
+        }
+    }
+
+    SUBCASE("Batches are full except possibly the last one") {
+        std::vector<size_t> sizes;
+        flatten(container.stream(side_cross, 4), &sizes);
+        CHECK(sizes == std::vector<size_t>{4, 4, 3});
+
+        sizes.clear();
+        flatten(container.stream(ascending), &sizes);
+        CHECK(sizes == std::vector<size_t>{11});  // The default batch (4096) holds the whole container.
+    }
+
+    SUBCASE("Consumers can stop early") {
+        Generator<std::vector<int>> batches = container.stream(ascending, 3);
+        auto it = batches.begin();
+        CHECK(*it == std::vector<int>{0, 1, 2});
+        ++it;
+        CHECK(*it == std::vector<int>{4, 6, 6});
+    }
+
+    SUBCASE("Empty containers yield no batches") {
+        MyContainer<int> empty;
+        std::vector<size_t> sizes;
+        CHECK(flatten(empty.stream(side_cross, 2), &sizes).empty());
+        CHECK(sizes.empty());
+    }
+
+    SUBCASE("A zero batch size is rejected") {
+        CHECK_THROWS_AS(container.stream(ascending, 0), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Binary search and range queries over the ascending order") {
+    MyContainer<int> container;
+    for (int value : {7, 15, 6, 1, 2, 6, 9}) {
+        container.addElement(value);
+    }
+    // Ascending: 1, 2, 6, 6, 7, 9, 15
+
+    auto collect = [](auto&& range) {
+        std::vector<int> out;
+        for (int value : range) out.push_back(value);
+        return out;
+    };
+
+    SUBCASE("The sorted permutation is cached and dropped on modification") {
+        CHECK_FALSE(container.has_sorted_indexes());
+        auto first = container.sorted_indexes();
+        CHECK(container.has_sorted_indexes());
+        CHECK(container.sorted_indexes() == first); // Same shared permutation, no re-sort
+
+        container.addElement(3);
+        CHECK_FALSE(container.has_sorted_indexes());
+        CHECK(container.sorted_indexes() != first);
+
+        CHECK_THROWS_AS(container.removeElement(100), std::runtime_error);
+        CHECK(container.has_sorted_indexes()); // A failed removal keeps the cache
+        container.removeElement(3);
+        CHECK_FALSE(container.has_sorted_indexes());
+    }
+
+    SUBCASE("lower_bound and upper_bound return iterators positioned mid-sequence") {
+        auto lower = container.lower_bound(6);
+        CHECK(*lower == 6);
+        CHECK(lower - container.begin_ascending_order() == 2);
+
+        auto upper = container.upper_bound(6);
+        CHECK(*upper == 7);
+        CHECK(upper - container.begin_ascending_order() == 4);
+
+        std::vector<int> rest;
+        for (auto it = container.upper_bound(6); it != container.end_ascending_order(); ++it) {
+            rest.push_back(*it);
+        }
+        CHECK(rest == std::vector<int>{7, 9, 15});
+
+        CHECK(container.lower_bound(100) == container.end_ascending_order());
+        CHECK(*container.lower_bound(-5) == 1);
+    }
+
+    SUBCASE("equal_range, rank and count_in_range") {
+        auto [first, last] = container.equal_range(6);
+        CHECK(last - first == 2);
+        CHECK(container.equal_range(5).first == container.equal_range(5).second);
+
+        CHECK(container.rank(1) == 0);
+        CHECK(container.rank(6) == 2);
+        CHECK(container.rank(8) == 5);
+        CHECK(container.rank(100) == 7);
+
+        CHECK(container.count_in_range(2, 9) == 4);  // 2, 6, 6, 7
+        CHECK(container.count_in_range(6, 7) == 2);
+        CHECK(container.count_in_range(9, 2) == 0);  // Empty when lo >= hi
+        CHECK(container.count_in_range(-10, 100) == 7);
+    }
+
+    SUBCASE("elements_in_range returns the [lo, hi) slice of the ascending order") {
+        CHECK(collect(container.elements_in_range(2, 9)) == std::vector<int>{2, 6, 6, 7});
+        CHECK(container.elements_in_range(2, 9).size() == 4);
+        CHECK(container.elements_in_range(8, 9).empty());
+        CHECK(container.elements_in_range(9, 2).empty());
+    }
+
+    SUBCASE("Queries on an empty container") {
+        MyContainer<int> empty;
+        CHECK(empty.lower_bound(1) == empty.end_ascending_order());
+        CHECK(empty.rank(1) == 0);
+        CHECK(empty.count_in_range(0, 10) == 0);
+    }
+}
+
+TEST_CASE("Order statistics and percentiles") {
+    MyContainer<double> latencies;
+    for (int i = 100; i >= 1; --i) {
+        latencies.addElement(i * 0.5); // 0.5, 1.0, ..., 50.0 in reverse insertion order
+    }
+
+    SUBCASE("nth_element_value selects without caching a sorted permutation") {
+        CHECK(latencies.nth_element_value(0) == 0.5);
+        CHECK(latencies.nth_element_value(49) == 25.0);
+        CHECK(latencies.nth_element_value(99) == 50.0);
+        CHECK_FALSE(latencies.has_sorted_indexes());
+        CHECK_THROWS_AS(latencies.nth_element_value(100), std::out_of_range);
+    }
+
+    SUBCASE("percentile uses the nearest-rank method") {
+        CHECK(latencies.percentile(0) == 0.5);
+        CHECK(latencies.percentile(50) == 25.0);
+        CHECK(latencies.percentile(90) == 45.0);
+        CHECK(latencies.percentile(99) == 49.5);
+        CHECK(latencies.percentile(99.9) == 50.0);
+        CHECK(latencies.percentile(100) == 50.0);
+        CHECK_THROWS_AS(latencies.percentile(-1), std::out_of_range);
+        CHECK_THROWS_AS(latencies.percentile(100.5), std::out_of_range);
+        CHECK_THROWS_AS(MyContainer<double>().percentile(50), std::out_of_range);
+    }
+
+    SUBCASE("percentiles answers several ranks in the requested order") {
+        std::vector<double> expected = {25.0, 45.0, 49.5, 50.0, 0.5, 25.0};
+        CHECK(latencies.percentiles({50, 90, 99, 99.9, 0, 50}) == expected);
+        CHECK_FALSE(latencies.has_sorted_indexes());
+
+        latencies.sorted_indexes(); // With a cached permutation the answers are lookups
+        CHECK(latencies.percentiles({50, 90, 99, 99.9, 0, 50}) == expected);
+        CHECK(latencies.nth_element_value(9) == 5.0);
+    }
+
+    SUBCASE("Multi-select agrees with a full sort on data with duplicates") {
+        MyContainer<int> values;
+        for (int i = 0; i < 257; ++i) {
+            values.addElement((i * 37) % 23);
+        }
+        std::vector<int> sorted(values.getElements());
+        std::sort(sorted.begin(), sorted.end());
+
+        std::vector<double> ps;
+        for (int p = 0; p <= 100; p += 5) ps.push_back(p);
+        std::vector<int> answers = values.percentiles(ps);
+        for (size_t i = 0; i < ps.size(); ++i) {
+            size_t rank = static_cast<size_t>(std::ceil(ps[i] / 100.0 * sorted.size()));
+            CHECK(answers[i] == sorted[rank == 0 ? 0 : rank - 1]);
+        }
+    }
+}
+
+TEST_CASE("ConcurrentMyContainer operations") {
+
+    SUBCASE("Writes are published as whole snapshots") {
+        ConcurrentMyContainer<int> shared;
+        shared.addElement(3);
+        shared.addElement(1);
+        std::shared_ptr<const MyContainer<int>> before = shared.read();
+
+        shared.update([](MyContainer<int>& c) {
+            c.addElement(2);
+            c.removeElement(3);
+        });
+        CHECK(shared.size() == 2);
+
+        // The earlier snapshot is unaffected by later writes.
+        CHECK(before->size() == 2);
+        CHECK(*before->begin_ascending_order() == 1);
+        CHECK(*before->begin_order() == 3);
+        CHECK(*shared.read()->begin_order() == 1);
+    }
+
+    SUBCASE("A failed write publishes nothing") {
+        ConcurrentMyContainer<int> shared(MyContainer<int>{});
+        shared.addElement(5);
+        auto before = shared.read();
+        CHECK_THROWS_AS(shared.removeElement(42), std::runtime_error);
+        CHECK(shared.read() == before);
+    }
+
+    SUBCASE("Multi-threaded stress: readers traverse every order while writers modify") {
+        ConcurrentMyContainer<int> shared;
+        constexpr int writers = 2;
+        constexpr int readers = 4;
+        constexpr int writes_per_writer = 400;
+        std::atomic<int> writers_done{0};
+        std::atomic<long> traversals{0};
+        std::atomic<bool> consistent{true};
+
+        std::vector<std::thread> threads;
+        for (int w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                for (int i = 0; i < writes_per_writer; ++i) {
+                    int value = w * 100000 + i;
+                    shared.addElement(value);
+                    if (i % 4 == 3) {
+                        shared.removeElement(value); // Every fourth value is removed again
+                    }
+                }
+                writers_done.fetch_add(1);
+            });
+        }
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r] {
+                long round = r;
+                do {
+                    std::shared_ptr<const MyContainer<int>> snapshot = shared.read();
+                    size_t n = snapshot->size();
+                    size_t count = 0;
+                    bool ok = true;
+                    switch (round++ % 6) {
+                        case 0: for (int x : snapshot->view(insertion)) { (void)x; ++count; } break;
+                        case 1: {
+                            int previous = -1;
+                            for (int x : snapshot->view(ascending)) { ok = ok && previous <= x; previous = x; ++count; }
+                            break;
+                        }
+                        case 2: {
+                            int previous = 1 << 30;
+                            for (int x : snapshot->view(descending)) { ok = ok && x <= previous; previous = x; ++count; }
+                            break;
+                        }
+                        case 3: for (int x : snapshot->view(reverse)) { (void)x; ++count; } break;
+                        case 4: for (int x : snapshot->view(side_cross)) { (void)x; ++count; } break;
+                        default: for (int x : snapshot->view(middle_out)) { (void)x; ++count; } break;
+                    }
+                    if (!ok || count != n) {
+                        consistent = false;
+                    }
+                    traversals.fetch_add(1);
+                } while (writers_done.load() < writers);
+            });
+        }
+        for (std::thread& t : threads) {
+            t.join();
+        }
+
+        CHECK(consistent.load());
+        CHECK(traversals.load() >= readers);
+        CHECK(shared.size() == static_cast<size_t>(writers * writes_per_writer * 3 / 4));
+    }
+
+    SUBCASE("Throughput: concurrent readers share one lazily built sorted permutation") {
+        MyContainer<int> initial;
+        for (int i = 0; i < 20000; ++i) {
+            initial.addElement((i * 7919) % 20000);
+        }
+        ConcurrentMyContainer<int> shared(std::move(initial));
+
+        constexpr int readers = 4;
+        std::atomic<long> elements_read{0};
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&] {
+                for (int round = 0; round < 20; ++round) {
+                    auto snapshot = shared.read();
+                    long local = 0;
+                    for (int x : snapshot->view(side_cross)) { local += (x >= 0); }
+                    elements_read.fetch_add(local);
+                }
+            });
+        }
+        for (std::thread& t : threads) {
+            t.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        MESSAGE("Concurrent side-cross throughput: " << elements_read.load() / (seconds * 1e6) << " M elements/s");
+
+        CHECK(elements_read.load() == readers * 20L * 20000);
+        CHECK(shared.read()->has_sorted_indexes());
+    }
+}
+
+// A value whose copies throw while 'fail' is set. With NothrowMove, moves never throw (so batches are
+// moved); without it, moves may throw (so batches are copied).
+template <bool NothrowMove>
+struct Fragile {
+    static inline bool fail = false;
+    int value = 0;
+
+    Fragile(int v) : value(v) {}
+    Fragile(const Fragile& other) : value(other.value) {
+        if (fail) {
+            throw std::runtime_error("Fragile: copy failed.");
+        }
+    }
+    Fragile(Fragile&& other) noexcept(NothrowMove) : value(other.value) {}
+    Fragile& operator=(const Fragile& other) = default;
+    Fragile& operator=(Fragile&& other) noexcept(NothrowMove) = default;
+    bool operator<(const Fragile& other) const { return value < other.value; }
+    bool operator==(const Fragile& other) const { return value == other.value; }
+};
+
+TEST_CASE("IngestBuffer multi-producer ingestion") {
+
+    SUBCASE("addElements appends a batch in order") {
+        MyContainer<int> container;
+        container.addElement(1);
+        container.sorted_indexes();
+        std::vector<int> batch = {4, 2, 3};
+        container.addElements(batch.begin(), batch.end());
+        CHECK(container.getElements() == std::vector<int>{1, 4, 2, 3});
+        CHECK_FALSE(container.has_sorted_indexes());
+    }
+
+    SUBCASE("A failed commit keeps its values for the next one") {
+        auto check_retry = [](auto tag) {
+            using V = decltype(tag);
+            IngestBuffer<V> buffer(2);
+            {
+                auto producer = buffer.producer();
+                for (int i = 0; i < 5; ++i) {
+                    producer.push(V(i));
+                }
+            }
+            MyContainer<V> container;
+            container.addElement(V(-1));
+            auto snapshot = container.snapshot(); // The commit must clone the shared elements, which copies.
+            ConcurrentMyContainer<V> published;
+            published.update([](MyContainer<V>& c) { c.addElement(V(-1)); });
+
+            V::fail = true;
+            CHECK_THROWS_AS(buffer.commit(container), std::runtime_error);
+            CHECK_THROWS_AS(buffer.commit(published), std::runtime_error);
+            V::fail = false;
+            CHECK(container.size() == 1);
+
+            {
+                auto producer = buffer.producer();
+                producer.push(V(5));
+            }
+            CHECK(buffer.commit(container) == 6);
+            CHECK(container.getElements() == std::vector<V>{-1, 0, 1, 2, 3, 4, 5});
+            CHECK(buffer.commit(container) == 0);
+        };
+        check_retry(Fragile<true>(0));  // Fails in addElements, after the batch was moved out.
+        check_retry(Fragile<false>(0)); // Fails while copying the batch out of the chunks.
+    }
+
+    SUBCASE("Empty batches and commits leave the container untouched") {
+        MyContainer<int> container;
+        container.addElement(1);
+        container.sorted_indexes();
+        auto snapshot = container.snapshot();
+        const std::uint64_t epoch = container.epoch();
+
+        std::vector<int> none;
+        container.addElements(none.begin(), none.end());
+        IngestBuffer<int> buffer;
+        CHECK(buffer.commit(container) == 0);
+
+        CHECK(container.epoch() == epoch);
+        CHECK(container.has_sorted_indexes());
+        CHECK(container.contents().data() == snapshot->contents().data());  // Still shared, not cloned.
+    }
+
+    SUBCASE("Values become visible per sealed chunk and keep producer order") {
+        IngestBuffer<int> buffer(3);
+        MyContainer<int> container;
+        {
+            IngestBuffer<int>::Producer producer = buffer.producer();
+            for (int i = 0; i < 7; ++i) {
+                producer.push(i);
+            }
+            CHECK(buffer.commit(container) == 6); // Two full chunks; 6 is still open
+            CHECK(container.getElements() == std::vector<int>{0, 1, 2, 3, 4, 5});
+        } // The producer flushes its open chunk when destroyed
+        CHECK(buffer.commit(container) == 1);
+        CHECK(buffer.commit(container) == 0);
+        CHECK(container.getElements() == std::vector<int>{0, 1, 2, 3, 4, 5, 6});
+    }
+
+    SUBCASE("Concurrent producers commit consistent per-producer prefixes") {
+        constexpr int producers = 8;
+        constexpr int per_producer = 5000;
+        IngestBuffer<int> buffer(64);
+        ConcurrentMyContainer<int> shared;
+        std::atomic<int> producers_done{0};
+        std::atomic<bool> consistent{true};
+
+        // Every committed snapshot must hold, for each producer, exactly its first k values in order.
+        auto check_prefixes = [&](const MyContainer<int>& snapshot) {
+            std::vector<int> next_expected(producers, 0);
+            for (int value : snapshot) {
+                int p = value / per_producer;
+                if (value % per_producer != next_expected[p]++) {
+                    consistent = false;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                IngestBuffer<int>::Producer producer = buffer.producer();
+                for (int i = 0; i < per_producer; ++i) {
+                    producer.push(p * per_producer + i);
+                }
+                producer.flush();
+                producers_done.fetch_add(1);
+            });
+        }
+        std::thread consumer([&] {
+            while (producers_done.load() < producers) {
+                buffer.commit(shared);
+                check_prefixes(*shared.read());
+            }
+            buffer.commit(shared);
+        });
+        for (std::thread& t : threads) {
+            t.join();
+        }
+        consumer.join();
+
+        CHECK(consistent.load());
+        CHECK(shared.size() == static_cast<size_t>(producers * per_producer));
+        check_prefixes(*shared.read());
+        CHECK(consistent.load());
+    }
+}
+
+TEST_CASE("Epoch-versioned snapshots") {
+    MyContainer<int> container;
+    CHECK(container.epoch() == 0);
+    container.addElement(5);
+    container.addElement(1);
+    container.addElement(3);
+    CHECK(container.epoch() == 3);
+
+    SUBCASE("A snapshot keeps its contents and epoch while the container changes") {
+        auto snap = container.snapshot();
+        auto it = snap->begin(ascending);
+        container.removeElement(1);
+        container.addElement(9);
+
+        CHECK(snap->epoch() == 3);
+        CHECK(container.epoch() == 5);
+        CHECK(snap->getElements() == std::vector<int>{5, 1, 3});
+        CHECK(container.getElements() == std::vector<int>{5, 3, 9});
+        std::vector<int> scanned(it, snap->end(ascending));
+        CHECK(scanned == std::vector<int>{1, 3, 5});
+    }
+
+    SUBCASE("Snapshots and copies share the elements until a modification") {
+        auto snap = container.snapshot();
+        MyContainer<int> copy(container);
+        CHECK(&snap->getElements() == &container.getElements());
+        CHECK(&copy.getElements() == &container.getElements());
+
+        copy.addElement(7);
+        CHECK(&copy.getElements() != &container.getElements());
+        CHECK(&snap->getElements() == &container.getElements());
+        CHECK(container.size() == 3);
+        CHECK(copy.epoch() == 4);
+    }
+
+    SUBCASE("A failed removal neither advances the epoch nor unshares the elements") {
+        auto snap = container.snapshot();
+        CHECK_THROWS_AS(container.removeElement(42), std::runtime_error);
+        CHECK(container.epoch() == 3);
+        CHECK(&snap->getElements() == &container.getElements());
+    }
+
+    SUBCASE("Moved-from containers are empty and usable") {
+        MyContainer<int> moved(std::move(container));
+        CHECK(moved.size() == 3);
+        CHECK(container.size() == 0);
+        container.addElement(2);
+        CHECK(container.getElements() == std::vector<int>{2});
+        CHECK(moved.getElements() == std::vector<int>{5, 1, 3});
+    }
+
+    SUBCASE("A long scan of a snapshot runs concurrently with mutations") {
+        for (int i = 0; i < 2000; ++i) {
+            container.addElement(i);
+        }
+        auto snap = container.snapshot();
+        long long expected = 0;
+        for (int v : snap->getElements()) {
+            expected += v;
+        }
+
+        std::atomic<long long> scanned{0};
+        std::thread reader([&] {
+            long long sum = 0;
+            for (auto it = snap->begin(descending); it != snap->end(descending); ++it) {
+                sum += *it;
+            }
+            scanned = sum;
+        });
+        for (int i = 0; i < 500; ++i) {
+            container.removeElement(i);
+            container.addElement(-i);
+        }
+        reader.join();
+
+        CHECK(scanned.load() == expected);
+        CHECK(snap->size() == 2003);
+        CHECK(container.size() == 2000); // removing 1, 3 and 5 also removed the initial copies
+    }
+}
+
+TEST_CASE("Parallel for_each over every traversal order") {
+    MyContainer<int> container;
+    for (int i = 0; i < 1000; ++i) {
+        container.addElement((i * 7919) % 1000);
+    }
+    WorkStealingPool pool(3);
+    CHECK(pool.worker_count() == 3);
+
+    // Visits every element of 'order' once, recording the values in visiting order per chunk.
+    auto visit_all = [&](auto order, size_t grain) {
+        std::mutex mutex;
+        std::vector<int> visited;
+        container.parallel_for_each(order, [&](const int& value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            visited.push_back(value);
+        }, grain, pool);
+        return visited;
+    };
+    auto sequential = [&](auto order) {
+        return std::vector<int>(container.begin(order), container.end(order));
+    };
+    auto same_elements = [](std::vector<int> a, std::vector<int> b) {
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return a == b;
+    };
+
+    SUBCASE("Every element is visited exactly once, for any grain") {
+        for (size_t grain : {size_t{0}, size_t{1}, size_t{7}, size_t{1000}, size_t{5000}}) {
+            CHECK(same_elements(visit_all(insertion, grain), sequential(insertion)));
+            CHECK(same_elements(visit_all(ascending, grain), sequential(ascending)));
+            CHECK(same_elements(visit_all(descending, grain), sequential(descending)));
+            CHECK(same_elements(visit_all(reverse, grain), sequential(reverse)));
+            CHECK(same_elements(visit_all(side_cross, grain), sequential(side_cross)));
+            CHECK(same_elements(visit_all(middle_out, grain), sequential(middle_out)));
+        }
+    }
+
+    SUBCASE("Chunks cover consecutive positions of the order") {
+        // The values are a permutation of 0..999, so every slot must be hit exactly once.
+        std::vector<std::atomic<int>> counts(1000);
+        container.parallel_for_each(side_cross, [&](const int& value) { counts[value].fetch_add(1); }, 1, pool);
+        CHECK(std::all_of(counts.begin(), counts.end(), [](const std::atomic<int>& c) { return c.load() == 1; }));
+
+        // A single chunk is processed in traversal order.
+        CHECK(visit_all(middle_out, 1000) == sequential(middle_out));
+        CHECK(visit_all(reverse, 1000) == sequential(reverse));
+    }
+
+    SUBCASE("Sorted orders share the cached permutation") {
+        auto cached = container.sorted_indexes();
+        visit_all(descending, 10);
+        visit_all(side_cross, 10);
+        CHECK(container.sorted_indexes() == cached);
+    }
+
+    SUBCASE("The pool is reused and exceptions reach the caller") {
+        std::atomic<long long> sum{0};
+        for (int round = 0; round < 20; ++round) {
+            container.parallel_for_each(ascending, [&](const int& value) { sum += value; }, 16, pool);
+        }
+        CHECK(sum.load() == 20LL * 999 * 1000 / 2);
+
+        CHECK_THROWS_AS(container.parallel_for_each(insertion, [](const int& value) {
+            if (value == 500) {
+                throw std::runtime_error("bad element");
+            }
+        }, 8, pool), std::runtime_error);
+
+        std::atomic<int> after{0};
+        container.parallel_for_each(insertion, [&](const int&) { ++after; }, 8, pool);
+        CHECK(after.load() == 1000);
+    }
+
+    SUBCASE("The shared pool and a pool without workers") {
+        std::atomic<int> visited{0};
+        container.parallel_for_each(middle_out, [&](const int&) { ++visited; });
+        CHECK(visited.load() == 1000);
+
+        WorkStealingPool inline_pool(0);
+        std::vector<int> values;
+        container.parallel_for_each(ascending, [&](const int& value) { values.push_back(value); }, 3, inline_pool);
+        CHECK(values == sequential(ascending));
+
+        MyContainer<int> empty;
+        empty.parallel_for_each(reverse, [&](const int&) { ++visited; }, 0, pool);
+        CHECK(visited.load() == 1000);
+    }
+}
+
+TEST_CASE("Splitting a traversal order into balanced parts") {
+    MyContainer<int> container;
+    for (int value : {8, 3, 11, 1, 6, 9, 2, 14, 5, 7}) {
+        container.addElement(value);
+    }
+
+    auto to_vector = [](const auto& part) {
+        std::vector<int> values;
+        for (int value : part) {
+            values.push_back(value);
+        }
+        return values;
+    };
+
+    // The parts, concatenated, must reproduce the order exactly.
+    auto check_split = [&](auto order, size_t n) {
+        auto parts = container.split(order, n);
+        REQUIRE(parts.size() == n);
+        std::vector<int> joined;
+        size_t smallest = container.size();
+        size_t largest = 0;
+        for (const auto& part : parts) {
+            for (int value : part) {
+                joined.push_back(value);
+            }
+            smallest = std::min(smallest, part.size());
+            largest = std::max(largest, part.size());
+        }
+        CHECK(joined == std::vector<int>(container.begin(order), container.end(order)));
+        CHECK(largest - smallest <= 1);
+    };
+
+    for (size_t n : {size_t{1}, size_t{3}, size_t{4}, size_t{10}, size_t{13}}) {
+        check_split(insertion, n);
+        check_split(ascending, n);
+        check_split(descending, n);
+        check_split(reverse, n);
+        check_split(side_cross, n);
+        check_split(middle_out, n);
+    }
+
+    SUBCASE("Parts follow the interleaved sequence, not the vector") {
+        auto parts = container.split(side_cross, 2);
+        CHECK(to_vector(parts[0]) == std::vector<int>{1, 14, 2, 11, 3});
+        CHECK(to_vector(parts[1]) == std::vector<int>{9, 5, 8, 6, 7});
+
+        auto halves = container.split(middle_out, 2);
+        CHECK(to_vector(halves[0]) == std::vector<int>{6, 1, 9, 11, 2});
+    }
+
+    SUBCASE("Parts share one snapshot and work with std::ranges") {
+        auto parts = container.split(ascending, 3);
+        CHECK(std::ranges::distance(parts[1]) == 3);
+        CHECK(std::ranges::min(parts[2]) == 8);
+        container.addElement(0);
+        CHECK(*parts[0].begin() == 1); // Existing parts keep their snapshot.
+    }
+
+    SUBCASE("Edge cases") {
+        CHECK_THROWS_AS(container.split(ascending, 0), std::invalid_argument);
+        MyContainer<int> empty;
+        auto parts = empty.split(reverse, 4);
+        CHECK(parts.size() == 4);
+        CHECK(std::all_of(parts.begin(), parts.end(), [](const auto& part) { return part.empty(); }));
+    }
+}
+
+TEST_CASE("Parallel bulk load") {
+    WorkStealingPool pool(3);
+    std::vector<int> upstream;
+    for (int i = 0; i < 5000; ++i) {
+        upstream.push_back((i * 7919) % 5003);
+    }
+    std::vector<int> sorted_upstream = upstream;
+    std::sort(sorted_upstream.begin(), sorted_upstream.end());
+
+    SUBCASE("Loads in insertion order and leaves the sorted permutation cached") {
+        for (size_t threads : {size_t{0}, size_t{1}, size_t{3}, size_t{7}}) {
+            MyContainer<int> loaded;
+            loaded.bulk_load(upstream, threads, pool);
+            CHECK(loaded.getElements() == upstream);
+            REQUIRE(loaded.has_sorted_indexes());
+            CHECK(std::vector<int>(loaded.begin(ascending), loaded.end(ascending)) == sorted_upstream);
+            CHECK(*loaded.begin(descending) == sorted_upstream.back());
+            CHECK(*loaded.begin(side_cross) == sorted_upstream.front());
+        }
+    }
+
+    SUBCASE("Appends to existing elements, reusing their cached permutation") {
+        MyContainer<int> container;
+        container.addElement(10000);
+        container.addElement(-1);
+        container.sorted_indexes();
+        container.bulk_load(upstream, 4, pool);
+        CHECK(container.size() == 5002);
+        CHECK(container.getElements()[0] == 10000);
+        CHECK(container.getElements()[2] == upstream[0]);
+        CHECK(*container.begin(ascending) == -1);
+        CHECK(*container.begin(descending) == 10000);
+        std::vector<int> ascending_values(container.begin(ascending), container.end(ascending));
+        CHECK(std::is_sorted(ascending_values.begin(), ascending_values.end()));
+
+        MyContainer<int> uncached;
+        uncached.addElement(3);
+        uncached.addElement(1);
+        uncached.bulk_load(std::vector<int>{2, 0}, 2, pool);
+        CHECK(std::vector<int>(uncached.begin(ascending), uncached.end(ascending)) == std::vector<int>{0, 1, 2, 3});
+    }
+
+    SUBCASE("Moves out of owning rvalue ranges and accepts non-random-access ranges") {
+        std::vector<std::string> words{"pear", "apple", "fig"};
+        MyContainer<std::string> container;
+        container.bulk_load(std::move(words), 2, pool);
+        CHECK(container.getElements() == std::vector<std::string>{"pear", "apple", "fig"});
+        CHECK(*container.begin(ascending) == "apple");
+
+        MyContainer<int> filtered;
+        filtered.bulk_load(upstream | std::views::filter([](int v) { return v % 2 == 0; }), 3, pool);
+        CHECK(filtered.size() == static_cast<size_t>(std::count_if(upstream.begin(), upstream.end(),
+                                                                   [](int v) { return v % 2 == 0; })));
+        CHECK(*filtered.begin(ascending) == 0);
+    }
+
+    SUBCASE("Empty loads") {
+        MyContainer<int> container;
+        container.bulk_load(std::vector<int>{}, 4, pool);
+        CHECK(container.size() == 0);
+        CHECK(container.begin(ascending) == container.end(ascending));
+
+        container.addElements(upstream.begin(), upstream.end());
+        auto by_magnitude = container.sorted_indexes(std::ranges::greater{});
+        auto snapshot = container.snapshot();
+        const std::uint64_t epoch = container.epoch();
+        container.bulk_load(std::vector<int>{}, 4, pool);
+        container.bulk_load(upstream | std::views::filter([](int v) { return v < 0; }), 4, pool);
+        CHECK(container.epoch() == epoch);
+        CHECK(container.contents().data() == snapshot->contents().data()); // Still shared, not cloned.
+        CHECK(container.sorted_indexes(std::ranges::greater{}) == by_magnitude);
+
+        const std::string path = (std::filesystem::temp_directory_path() / "mycontainer_empty_load.bin").string();
+        container.save(path);
+        {
+            MyContainer<int> mapped = MyContainer<int>::map(path);
+            const int* data = mapped.contents().data();
+            mapped.bulk_load(std::vector<int>{}, 4, pool);
+            CHECK(mapped.is_mapped());
+            CHECK(mapped.contents().data() == data);
+            CHECK(mapped.epoch() == 0);
+        }
+        std::filesystem::remove(path);
+    }
+}
+
+// A user type saved through the binary_codec customization point.
+struct Reading {
+    std::string sensor;
+    double value;
+    bool operator<(const Reading& other) const { return value < other.value; }
+    bool operator==(const Reading& other) const { return sensor == other.sensor && value == other.value; }
+};
+
+template <>
+struct Container::binary_codec<Reading> {
+    static constexpr bool bulk = false;
+    static void write(std::ostream& out, const Reading& r) {
+        binary_codec<std::string>::write(out, r.sensor);
+        binary_codec<double>::write(out, r.value);
+    }
+    static Reading read(std::istream& in) {
+        Reading r;
+        r.sensor = binary_codec<std::string>::read(in);
+        r.value = binary_codec<double>::read(in);
+        return r;
+    }
+};
+
+TEST_CASE("Binary serialization") {
+    SUBCASE("Trivially copyable elements round-trip bit-exactly") {
+        MyContainer<double> container;
+        for (double value : {0.1, -2.5e300, 1.0 / 3.0, 4.9e-324, -0.0, 7.25}) {
+            container.addElement(value);
+        }
+        std::stringstream buffer;
+        container.save(buffer);
+        CHECK(buffer.str().size() == sizeof(BinaryHeader) + 6 * sizeof(double));
+
+        MyContainer<double> loaded = MyContainer<double>::load(buffer);
+        CHECK(loaded.getElements() == container.getElements());
+        CHECK(std::signbit(loaded.getElements()[4]));
+        CHECK_FALSE(loaded.has_sorted_indexes());
+    }
+
+    SUBCASE("The sorted permutation can be persisted and is ready after loading") {
+        MyContainer<int> container;
+        for (int value : {7, 15, 6, 1, 2}) {
+            container.addElement(value);
+        }
+        std::stringstream buffer;
+        container.save(buffer, true);
+        MyContainer<int> loaded = MyContainer<int>::load(buffer);
+        REQUIRE(loaded.has_sorted_indexes());
+        CHECK(*loaded.sorted_indexes() == *container.sorted_indexes());
+        CHECK(std::vector<int>(loaded.begin(side_cross), loaded.end(side_cross)) == std::vector<int>{1, 15, 2, 7, 6});
+    }
+
+    SUBCASE("Odd-sized elements are padded so the permutation stays aligned") {
+        MyContainer<char> container;
+        for (char c : {'d', 'a', 'c'}) {
+            container.addElement(c);
+        }
+        std::stringstream buffer;
+        container.save(buffer, true);
+        CHECK(buffer.str().size() == sizeof(BinaryHeader) + 8 + 3 * sizeof(std::uint64_t));
+        MyContainer<char> loaded = MyContainer<char>::load(buffer);
+        CHECK(std::vector<char>(loaded.begin(ascending), loaded.end(ascending)) == std::vector<char>{'a', 'c', 'd'});
+    }
+
+    SUBCASE("Strings and user types use their codec") {
+        MyContainer<std::string> words;
+        words.addElement("banana");
+        words.addElement("");
+        words.addElement(std::string("with\0nul", 8));
+        std::stringstream buffer;
+        words.save(buffer, true);
+        MyContainer<std::string> loaded = MyContainer<std::string>::load(buffer);
+        CHECK(loaded.getElements() == words.getElements());
+        CHECK(*loaded.begin(ascending) == "");
+
+        MyContainer<Reading> readings;
+        readings.addElement({"north", 3.5});
+        readings.addElement({"south", -1.25});
+        std::stringstream reading_buffer;
+        readings.save(reading_buffer);
+        CHECK(MyContainer<Reading>::load(reading_buffer).getElements() == readings.getElements());
+    }
+
+    SUBCASE("Invalid input is rejected") {
+        MyContainer<int> container;
+        container.addElement(1);
+        container.addElement(2);
+        std::stringstream buffer;
+        container.save(buffer, true);
+        const std::string bytes = buffer.str();
+
+        std::stringstream truncated(bytes.substr(0, bytes.size() - 3));
+        CHECK_THROWS_AS(MyContainer<int>::load(truncated), std::runtime_error);
+
+        std::stringstream wrong_type(bytes);
+        CHECK_THROWS_AS(MyContainer<long long>::load(wrong_type), std::runtime_error);
+        std::stringstream not_strings(bytes);
+        CHECK_THROWS_AS(MyContainer<std::string>::load(not_strings), std::runtime_error);
+
+        std::string bad_magic = bytes;
+        bad_magic[0] = 'X';
+        std::stringstream bad_magic_stream(bad_magic);
+        CHECK_THROWS_AS(MyContainer<int>::load(bad_magic_stream), std::runtime_error);
+
+        std::string bad_permutation = bytes;
+        bad_permutation[bytes.size() - 8] = 0; // Second index now repeats the first one (0).
+        bad_permutation[bytes.size() - 16] = 0;
+        std::stringstream bad_permutation_stream(bad_permutation);
+        CHECK_THROWS_AS(MyContainer<int>::load(bad_permutation_stream), std::runtime_error);
+    }
+}
+
+TEST_CASE("Memory-mapped containers") {
+    const std::string path = (std::filesystem::temp_directory_path() / "mycontainer_map_test.bin").string();
+    MyContainer<int> original;
+    for (int value : {7, 15, 6, 1, 2}) {
+        original.addElement(value);
+    }
+
+    SUBCASE("All traversal orders read the mapped file in place") {
+        original.save(path);
+        MyContainer<int> mapped = MyContainer<int>::map(path);
+        CHECK(mapped.is_mapped());
+        CHECK(mapped.size() == 5);
+        CHECK(std::vector<int>(mapped.contents().begin(), mapped.contents().end()) == original.getElements());
+        CHECK_THROWS_AS(mapped.getElements(), std::logic_error);
+
+        CHECK(std::vector<int>(mapped.begin(insertion), mapped.end(insertion)) == std::vector<int>{7, 15, 6, 1, 2});
+        CHECK(std::vector<int>(mapped.begin(ascending), mapped.end(ascending)) == std::vector<int>{1, 2, 6, 7, 15});
+        CHECK(std::vector<int>(mapped.begin(descending), mapped.end(descending)) == std::vector<int>{15, 7, 6, 2, 1});
+        CHECK(std::vector<int>(mapped.begin(reverse), mapped.end(reverse)) == std::vector<int>{2, 1, 6, 15, 7});
+        CHECK(std::vector<int>(mapped.begin(side_cross), mapped.end(side_cross)) == std::vector<int>{1, 15, 2, 7, 6});
+        CHECK(std::vector<int>(mapped.begin(middle_out), mapped.end(middle_out)) == std::vector<int>{6, 15, 1, 7, 2});
+        CHECK(mapped.rank(7) == 3);
+        CHECK(mapped.percentile(50) == 6);
+
+        std::ostringstream oss;
+        oss << mapped;
+        CHECK(oss.str() == "MyContainer elements: [7, 15, 6, 1, 2]");
+    }
+
+    SUBCASE("A persisted permutation is ready after mapping") {
+        original.save(path, true);
+        MyContainer<int> mapped = MyContainer<int>::map(path);
+        REQUIRE(mapped.has_sorted_indexes());
+        CHECK(*mapped.sorted_indexes() == *original.sorted_indexes());
+    }
+
+    SUBCASE("Copies share the mapping and modification moves the elements to the heap") {
+        original.save(path);
+        MyContainer<int> mapped = MyContainer<int>::map(path);
+        auto snap = mapped.snapshot();
+        MyContainer<int> copy(mapped);
+        CHECK(copy.contents().data() == mapped.contents().data());
+
+        mapped.addElement(3);
+        CHECK_FALSE(mapped.is_mapped());
+        CHECK(mapped.getElements() == std::vector<int>{7, 15, 6, 1, 2, 3});
+        CHECK(snap->is_mapped());
+        CHECK(std::vector<int>(snap->begin(ascending), snap->end(ascending)) == std::vector<int>{1, 2, 6, 7, 15});
+
+        copy.removeElement(15);
+        CHECK(copy.getElements() == std::vector<int>{7, 6, 1, 2});
+        CHECK(MyContainer<int>::map(path).size() == 5); // The file itself is never written.
+    }
+
+    SUBCASE("Empty containers and file round trips") {
+        MyContainer<double> empty;
+        empty.save(path, true);
+        MyContainer<double> mapped = MyContainer<double>::map(path);
+        CHECK(mapped.size() == 0);
+        CHECK(mapped.begin(side_cross) == mapped.end(side_cross));
+
+        original.save(path, true);
+        CHECK(MyContainer<int>::load(path).getElements() == original.getElements());
+    }
+
+    SUBCASE("Invalid files are rejected") {
+        CHECK_THROWS_AS(MyContainer<int>::map(path + ".missing"), std::system_error);
+
+        original.save(path, true);
+        CHECK_THROWS_AS(MyContainer<long long>::map(path), std::runtime_error);
+
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+        CHECK_THROWS_AS(MyContainer<int>::map(path), std::runtime_error);
+
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "MYCT";
+        CHECK_THROWS_AS(MyContainer<int>::map(path), std::runtime_error);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Persisted sorted index sidecar") {
+    const std::string data_path = (std::filesystem::temp_directory_path() / "mycontainer_sidecar_test.bin").string();
+    const std::string index_path = data_path + ".idx";
+    MyContainer<int> original;
+    for (int value : {7, 15, 6, 1, 2}) {
+        original.addElement(value);
+    }
+    original.save(data_path);
+    original.save_sorted_index(index_path);
+
+    SUBCASE("A matching sidecar makes the sorted orders ready without sorting") {
+        MyContainer<int> mapped = MyContainer<int>::map(data_path);
+        CHECK_FALSE(mapped.has_sorted_indexes());
+        CHECK(mapped.load_sorted_index(index_path));
+        REQUIRE(mapped.has_sorted_indexes());
+        CHECK(*mapped.sorted_indexes() == *original.sorted_indexes());
+        CHECK(std::vector<int>(mapped.begin(descending), mapped.end(descending)) == std::vector<int>{15, 7, 6, 2, 1});
+        CHECK(std::vector<int>(mapped.begin(side_cross), mapped.end(side_cross)) == std::vector<int>{1, 15, 2, 7, 6});
+
+        MyContainer<int> loaded = MyContainer<int>::load(data_path);
+        CHECK(loaded.load_sorted_index(index_path));
+    }
+
+    SUBCASE("A sidecar for other contents or a missing one is ignored") {
+        MyContainer<int> changed(original);
+        changed.removeElement(15);
+        changed.addElement(16); // Same count, different contents.
+        CHECK_FALSE(changed.load_sorted_index(index_path));
+        CHECK_FALSE(changed.has_sorted_indexes());
+
+        MyContainer<int> shorter;
+        shorter.addElement(1);
+        CHECK_FALSE(shorter.load_sorted_index(index_path));
+        CHECK_FALSE(original.load_sorted_index(index_path + ".missing"));
+    }
+
+    SUBCASE("Strings are checksummed through their codec") {
+        MyContainer<std::string> words;
+        for (const char* word : {"pear", "apple", "fig"}) {
+            words.addElement(word);
+        }
+        words.save_sorted_index(index_path);
+        MyContainer<std::string> same;
+        for (const char* word : {"pear", "apple", "fig"}) {
+            same.addElement(word);
+        }
+        CHECK(same.load_sorted_index(index_path));
+        CHECK(*same.begin(ascending) == "apple");
+
+        MyContainer<std::string> regrouped; // Same characters, different boundaries.
+        for (const char* word : {"pea", "rapple", "fig"}) {
+            regrouped.addElement(word);
+        }
+        CHECK_FALSE(regrouped.load_sorted_index(index_path));
+    }
+
+    SUBCASE("Malformed sidecars are rejected") {
+        CHECK_THROWS_AS(original.load_sorted_index(data_path), std::runtime_error);
+        std::filesystem::resize_file(index_path, std::filesystem::file_size(index_path) - 8);
+        CHECK_THROWS_AS(original.load_sorted_index(index_path), std::runtime_error);
+    }
+
+    std::filesystem::remove(data_path);
+    std::filesystem::remove(index_path);
+}
+
+TEST_CASE("Fast printing") {
+    // Reference output: every element inserted into the stream one by one.
+    auto reference = [](std::ostream& os, const auto& values) {
+        std::ostringstream expected;
+        expected.copyfmt(os);
+        expected << "MyContainer elements: [";
+        for (size_t i = 0; i < values.size(); ++i) {
+            expected << (i == 0 ? "" : ", ") << values[i];
+        }
+        expected << "]";
+        return expected.str();
+    };
+
+    SUBCASE("Numbers match per-element stream insertion") {
+        MyContainer<double> doubles;
+        for (double value : {0.1, -2.5e300, 1.0 / 3.0, 4.9e-324, -0.0, 7.25, 1e6, 123456789.0, 1e-5}) {
+            doubles.addElement(value);
+        }
+        std::ostringstream oss;
+        oss << doubles;
+        CHECK(oss.str() == reference(oss, doubles.getElements()));
+
+        std::ostringstream precise;
+        precise.precision(15);
+        doubles.print(precise, insertion);
+        CHECK(precise.str() == reference(precise, doubles.getElements()));
+
+        MyContainer<float> floats;
+        floats.addElement(3.14159265f);
+        floats.addElement(-1e-20f);
+        std::ostringstream float_out;
+        float_out << floats;
+        CHECK(float_out.str() == reference(float_out, floats.getElements()));
+
+        MyContainer<long long> longs;
+        longs.addElement(-9223372036854775807LL - 1);
+        longs.addElement(42);
+        std::ostringstream long_out;
+        long_out << longs;
+        CHECK(long_out.str() == "MyContainer elements: [-9223372036854775808, 42]");
+    }
+
+    SUBCASE("Customized streams and non-numeric types fall back to operator<<") {
+        MyContainer<int> ints;
+        ints.addElement(255);
+        ints.addElement(16);
+        std::ostringstream hex_out;
+        hex_out << std::hex << std::showbase << ints;
+        CHECK(hex_out.str() == "MyContainer elements: [0xff, 0x10]");
+
+        std::ostringstream fixed_out;
+        MyContainer<double> doubles;
+        doubles.addElement(2.5);
+        fixed_out << std::fixed << doubles;
+        CHECK(fixed_out.str() == "MyContainer elements: [2.500000]");
+
+        MyContainer<char> chars;
+        chars.addElement('b');
+        chars.addElement('a');
+        std::ostringstream char_out;
+        char_out << chars;
+        CHECK(char_out.str() == "MyContainer elements: [b, a]");
+    }
+
+    SUBCASE("Any traversal order, in small chunks") {
+        MyContainer<int> ints;
+        for (int value : {7, 15, 6, 1, 2}) {
+            ints.addElement(value);
+        }
+        std::ostringstream side_cross_out;
+        ints.print(side_cross_out, side_cross, 1);
+        CHECK(side_cross_out.str() == "MyContainer elements: [1, 15, 2, 7, 6]");
+
+        std::ostringstream descending_out;
+        ints.print(descending_out, descending, 4);
+        CHECK(descending_out.str() == "MyContainer elements: [15, 7, 6, 2, 1]");
+
+        MyContainer<int> large;
+        std::vector<int> values;
+        for (int i = 0; i < 100000; ++i) {
+            values.push_back(i * 37 - 1000000);
+        }
+        large.addElements(values.begin(), values.end());
+        std::ostringstream chunked;
+        large.print(chunked, insertion, 100);
+        CHECK(chunked.str() == reference(chunked, values));
+    }
+}
+
+TEST_CASE("Streaming text ingestion") {
+    SUBCASE("Newline- and comma-separated values") {
+        std::istringstream lines("3\n-1\n42\n");
+        CHECK(MyContainer<int>::load_text(lines).getElements() == std::vector<int>{3, -1, 42});
+
+        std::istringstream csv("1.5,2e3, -0.25\r\n+7,,8\n\n");
+        CHECK(MyContainer<double>::load_text(csv, ',').getElements() == std::vector<double>{1.5, 2000.0, -0.25, 7.0, 8.0});
+
+        std::istringstream empty("");
+        CHECK(MyContainer<int>::load_text(empty).size() == 0);
+
+        std::istringstream no_trailing_newline("10\n20");
+        CHECK(MyContainer<long long>::load_text(no_trailing_newline).getElements() == std::vector<long long>{10, 20});
+    }
+
+    SUBCASE("Space- and tab-separated values") {
+        std::istringstream spaces("1 2 3\n4  5\n");
+        CHECK(MyContainer<int>::load_text(spaces, ' ').getElements() == std::vector<int>{1, 2, 3, 4, 5});
+
+        std::istringstream tabs("1\t2\t 3\r\n-4\t\t5\n");
+        CHECK(MyContainer<int>::load_text(tabs, '\t').getElements() == std::vector<int>{1, 2, 3, -4, 5});
+    }
+
+    SUBCASE("Invalid fields are rejected") {
+        std::istringstream not_a_number("1\nabc\n3\n");
+        CHECK_THROWS_AS(MyContainer<int>::load_text(not_a_number), std::runtime_error);
+        std::istringstream fraction("1\n2.5\n");
+        CHECK_THROWS_AS(MyContainer<int>::load_text(fraction), std::runtime_error);
+        std::istringstream too_large("70000\n");
+        CHECK_THROWS_AS(MyContainer<short>::load_text(too_large), std::runtime_error);
+        std::istringstream two_values("1 2\n");
+        CHECK_THROWS_AS(MyContainer<int>::load_text(two_values), std::runtime_error);
+    }
+
+    SUBCASE("Large inputs across block boundaries, with and without read-ahead") {
+        std::vector<long long> expected;
+        std::string text;
+        for (long long i = 0; i < 400000; ++i) {
+            long long value = i * 7919 - 1000000000LL;
+            expected.push_back(value);
+            text += std::to_string(value);
+            text += (i % 10 == 9) ? "\n" : ",";
+        }
+        REQUIRE(text.size() > (size_t{1} << 22));
+
+        std::istringstream direct(text);
+        CHECK(MyContainer<long long>::load_text(direct, ',').getElements() == expected);
+        std::istringstream pipelined(text);
+        CHECK(MyContainer<long long>::load_text(pipelined, ',', true).getElements() == expected);
+
+        std::string broken = text;
+        broken[broken.size() - 100] = 'x';
+        std::istringstream broken_stream(broken);
+        CHECK_THROWS_AS(MyContainer<long long>::load_text(broken_stream, ',', true), std::runtime_error);
+
+        const std::string path = (std::filesystem::temp_directory_path() / "mycontainer_text_test.csv").string();
+        std::ofstream(path, std::ios::binary) << text;
+        CHECK(MyContainer<long long>::load_text(path, ',', true).getElements() == expected);
+        std::filesystem::remove(path);
+        CHECK_THROWS_AS(MyContainer<long long>::load_text(path), std::runtime_error);
+    }
+}
+
+TEST_CASE("External-memory sorted traversal") {
+    const std::filesystem::path spill = std::filesystem::temp_directory_path() / "mycontainer_spill_test";
+    std::filesystem::create_directories(spill);
+    auto spilled_files = [&] {
+        return std::distance(std::filesystem::directory_iterator(spill), std::filesystem::directory_iterator());
+    };
+
+    std::vector<int> values;
+    for (int i = 0; i < 20000; ++i) {
+        values.push_back((i * 7919) % 10007 - 5000);
+    }
+    MyContainer<int> reference;
+    reference.addElements(values.begin(), values.end());
+    auto in_order = [](auto&& range) {
+        std::vector<int> out;
+        for (int value : range) {
+            out.push_back(value);
+        }
+        return out;
+    };
+
+    SUBCASE("Ascending, descending and side-cross match the in-memory orders") {
+        ExternalSorter<int> sorter(spill, 4096); // 1024 ints per run
+        sorter.add_range(values);
+        ExternalSortedRuns<int> runs = sorter.finish();
+        CHECK(runs.size() == values.size());
+        CHECK(runs.run_count() == 20);
+
+        CHECK(in_order(runs.view(ascending)) == std::vector<int>(reference.begin(ascending), reference.end(ascending)));
+        CHECK(in_order(runs.view(descending)) == std::vector<int>(reference.begin(descending), reference.end(descending)));
+        CHECK(in_order(runs.view(side_cross)) == std::vector<int>(reference.begin(side_cross), reference.end(side_cross)));
+        CHECK(runs.run_count() <= 4); // Merged in passes to respect the 4 KiB budget.
+    }
+
+    SUBCASE("Iterators, odd sizes and a single run") {
+        ExternalSorter<int> sorter(spill, 1 << 20);
+        for (int value : {5, 1, 4, 2, 3}) {
+            sorter.add(value);
+        }
+        ExternalSortedRuns<int> runs = sorter.finish();
+        CHECK(runs.run_count() == 1);
+        auto it = runs.begin(side_cross);
+        std::vector<int> side;
+        for (; it != runs.end(side_cross); ++it) {
+            side.push_back(*it);
+        }
+        CHECK(side == std::vector<int>{1, 5, 2, 4, 3});
+        CHECK(in_order(runs.view(descending)) == std::vector<int>{5, 4, 3, 2, 1});
+        static_assert(std::input_iterator<ExternalSortedRuns<int>::OrderedIterator<AscendingOrder>>);
+    }
+
+    SUBCASE("Empty input and cleanup of the spill directory") {
+        {
+            ExternalSorter<double> sorter(spill, 64);
+            ExternalSortedRuns<double> runs = sorter.finish();
+            CHECK(runs.size() == 0);
+            CHECK(runs.begin(ascending) == runs.end(ascending));
+        }
+        {
+            ExternalSorter<int> unfinished(spill, 64);
+            unfinished.add_range(values);
+            CHECK(spilled_files() > 0);
+        }
+        CHECK(spilled_files() == 0);
+        CHECK_THROWS_AS(ExternalSorter<int>(spill / "missing", 64), std::runtime_error);
+    }
+
+    SUBCASE("A budget of one element merges in many passes") {
+        ExternalSorter<int> sorter(spill, 1);
+        sorter.add_range(values | std::views::take(300));
+        ExternalSortedRuns<int> runs = sorter.finish();
+        CHECK(runs.run_count() == 300);
+        std::vector<int> expected(values.begin(), values.begin() + 300);
+        std::sort(expected.begin(), expected.end());
+        CHECK(in_order(runs.view(ascending)) == expected);
+        CHECK(runs.run_count() == 2);
+        CHECK(spilled_files() == 2);
+        CHECK(in_order(runs.view(descending)) == std::vector<int>(expected.rbegin(), expected.rend()));
+    }
+
+    SUBCASE("A failed merge pass leaves the runs and the spill directory as they were") {
+        // Two ints per run, merged two at a time: 8 runs of 8 bytes, then 4 of 16, then 2 of 32.
+        ExternalSorter<int> sorter(spill, 2 * sizeof(int));
+        for (int i = 0; i < 16; ++i) {
+            sorter.add(i);
+        }
+        ExternalSortedRuns<int> runs = sorter.finish();
+        CHECK(runs.run_count() == 8);
+        std::vector<int> expected(16);
+        for (int i = 0; i < 16; ++i) {
+            expected[i] = i;
+        }
+
+        SUBCASE("A write fails") {
+            // Files may not grow past 24 bytes: the first pass succeeds, the second fails mid-file.
+            rlimit saved{};
+            REQUIRE(getrlimit(RLIMIT_FSIZE, &saved) == 0);
+            rlimit limited = saved;
+            limited.rlim_cur = 24;
+            auto previous = std::signal(SIGXFSZ, SIG_IGN);
+            REQUIRE(setrlimit(RLIMIT_FSIZE, &limited) == 0);
+            bool threw = false;
+            try {
+                runs.begin(ascending);
+            } catch (const std::runtime_error& error) {
+                threw = std::string(error.what()).find("ExternalSortedRuns: cannot write run") == 0;
+            }
+            setrlimit(RLIMIT_FSIZE, &saved);
+            std::signal(SIGXFSZ, previous);
+            CHECK(threw);
+            CHECK(runs.run_count() == 4); // The completed first pass, without the partial second one.
+            CHECK(spilled_files() == 4);
+            CHECK(in_order(runs.view(ascending)) == expected);
+        }
+
+        SUBCASE("A run of a later group is missing") {
+            for (const auto& entry : std::filesystem::directory_iterator(spill)) {
+                std::ifstream in(entry.path(), std::ios::binary);
+                int first = 0;
+                in.read(reinterpret_cast<char*>(&first), sizeof(first));
+                in.close();
+                if (first == 14) { // The last run, merged by the last group of the first pass.
+                    std::filesystem::remove(entry.path());
+                }
+            }
+            CHECK_THROWS_AS(runs.begin(ascending), std::runtime_error);
+            CHECK(runs.run_count() == 8);
+            CHECK(spilled_files() == 7); // The earlier groups' merged files were removed.
+        }
+    }
+
+    std::filesystem::remove_all(spill);
+}
+
+TEST_CASE("Compressed integer storage") {
+    // Compares every traversal order of a compressed container with the same data in a MyContainer.
+    auto check_orders = [](const auto& compressed, const auto& plain) {
+        using V = typename std::decay_t<decltype(plain)>::OrderIterator::value_type;
+        auto same = [&](auto order) {
+            return std::vector<V>(compressed.begin(order), compressed.end(order)) ==
+                   std::vector<V>(plain.begin(order), plain.end(order));
+        };
+        CHECK(same(insertion));
+        CHECK(same(ascending));
+        CHECK(same(descending));
+        CHECK(same(reverse));
+        CHECK(same(side_cross));
+        CHECK(same(middle_out));
+        CHECK(*compressed.sorted_indexes() == *plain.sorted_indexes());  // Same tie order, too.
+    };
+
+    SUBCASE("Monotone IDs use delta blocks") {
+        MyContainer<std::int64_t> ids;
+        for (std::int64_t i = 0; i < 10000; ++i) {
+            ids.addElement(1000000000000LL + i * 3 + (i % 7 == 0 ? 1 : 0));
+        }
+        CompressedContainer<std::int64_t> compressed(ids);
+        CHECK(compressed.size() == ids.size());
+        CHECK(compressed.decode() == ids.getElements());
+        CHECK(compressed.compressed_bytes() * 5 < ids.size() * sizeof(std::int64_t));
+        check_orders(compressed, ids);
+    }
+
+    SUBCASE("Jittered timestamps use delta blocks that are not sorted by position") {
+        MyContainer<std::int64_t> stamps;
+        for (std::int64_t i = 0; i < 5000; ++i) {
+            stamps.addElement(1700000000000LL + i * 100 + (i * 37) % 150);  // Rises overall, dips now and then.
+        }
+        CompressedContainer<std::int64_t> compressed(stamps);
+        CHECK(compressed.compressed_bytes() * 4 < stamps.size() * sizeof(std::int64_t));
+        check_orders(compressed, stamps);
+    }
+
+    SUBCASE("Low-cardinality codes and extreme values") {
+        MyContainer<int> codes;
+        for (int i = 0; i < 1000; ++i) {
+            codes.addElement(i % 5 - 2);
+        }
+        CompressedContainer<int> compressed(codes);
+        CHECK(compressed.compressed_bytes() * 3 < codes.size() * sizeof(int));
+        check_orders(compressed, codes);
+
+        MyContainer<std::int64_t> extremes;
+        for (int i = 0; i < 300; ++i) {
+            extremes.addElement(i % 3 == 0 ? INT64_MIN : (i % 3 == 1 ? INT64_MAX : 0));
+        }
+        CompressedContainer<std::int64_t> wide(extremes);
+        CHECK(wide.decode() == extremes.getElements());
+        check_orders(wide, extremes);
+
+        MyContainer<std::uint8_t> bytes;
+        for (int i = 0; i < 500; ++i) {
+            bytes.addElement(static_cast<std::uint8_t>(255 - i));
+        }
+        CompressedContainer<std::uint8_t> small(bytes);
+        CHECK(small.decode() == bytes.getElements());
+        check_orders(small, bytes);
+    }
+
+    SUBCASE("Modification and conversion") {
+        CompressedContainer<int> compressed;
+        std::vector<int> values{9, 4, 7, 4, 1};
+        compressed.addElements(values.begin(), values.end());
+        compressed.addElement(12);
+        CHECK(*compressed.begin(ascending) == 1);
+        compressed.removeElement(4);
+        CHECK(compressed.decode() == std::vector<int>{9, 7, 1, 12});
+        CHECK(*compressed.begin(descending) == 12);
+        CHECK_THROWS_AS(compressed.removeElement(100), std::runtime_error);
+        CHECK(compressed.decompress().getElements() == std::vector<int>{9, 7, 1, 12});
+        CHECK(compressed.value_at(3) == 12);
+
+        CompressedContainer<int> copy(compressed);
+        copy.addElement(0);
+        CHECK(copy.size() == 5);
+        CHECK(compressed.size() == 4);
+
+        CompressedContainer<int> moved(std::move(copy));
+        CHECK(moved.size() == 5);
+        CHECK(copy.size() == 0);
+        copy = std::move(moved);
+        CHECK(copy.decode() == std::vector<int>{9, 7, 1, 12, 0});
+        CHECK(*copy.begin(ascending) == 0);
+        static_assert(std::is_nothrow_move_constructible_v<CompressedContainer<int>>);
+        static_assert(std::forward_iterator<CompressedContainer<int>::OrderedIterator<MiddleOutOrder>>);
+
+        if constexpr (checked_iterators) {
+            CHECK_THROWS_AS(*compressed.end(ascending), std::out_of_range);
+        }
+    }
+}
+
+TEST_CASE("Dictionary-encoded strings") {
+    MyContainer<std::string> plain;
+    const std::vector<std::string> categories{"red", "green", "blue", "amber", "green", "red", "red", "violet", "blue"};
+    for (int round = 0; round < 50; ++round) {
+        for (const std::string& category : categories) {
+            plain.addElement(category);
+        }
+    }
+    DictionaryContainer dictionary(plain);
+
+    SUBCASE("Repeated strings are stored once and every order matches MyContainer") {
+        CHECK(dictionary.size() == plain.size());
+        CHECK(dictionary.distinct_count() == 5);
+        CHECK(dictionary.codes().size() == plain.size());
+        CHECK(dictionary.decode().getElements() == plain.getElements());
+
+        auto same = [&](auto order) {
+            return std::vector<std::string>(dictionary.begin(order), dictionary.end(order)) ==
+                   std::vector<std::string>(plain.begin(order), plain.end(order));
+        };
+        CHECK(same(insertion));
+        CHECK(same(ascending));
+        CHECK(same(descending));
+        CHECK(same(reverse));
+        CHECK(same(side_cross));
+        CHECK(same(middle_out));
+    }
+
+    SUBCASE("Equal strings keep insertion order in the sorted permutation") {
+        auto sorted = dictionary.sorted_indexes();
+        CHECK(std::is_sorted(sorted->begin(), sorted->begin() + 50)); // All "amber", by index.
+        CHECK(dictionary[(*sorted)[0]] == "amber");
+        CHECK(dictionary[(*sorted)[sorted->size() - 1]] == "violet");
+    }
+
+    SUBCASE("New strings and removals") {
+        dictionary.addElement("aqua");
+        CHECK(*dictionary.begin(ascending) == "amber");
+        CHECK(dictionary.distinct_count() == 6);
+        dictionary.removeElement("amber");
+        CHECK(*dictionary.begin(ascending) == "aqua");
+        CHECK(dictionary.size() == plain.size() + 1 - 50);
+        CHECK_THROWS_AS(dictionary.removeElement("amber"), std::runtime_error); // Interned but no longer present.
+        CHECK_THROWS_AS(dictionary.removeElement("black"), std::runtime_error);
+
+        DictionaryContainer copy(dictionary);
+        copy.addElement("zinc");
+        CHECK(*copy.begin(descending) == "zinc");
+        CHECK(*dictionary.begin(descending) == "violet");
+        CHECK(copy.value_of(copy.codes().contents().back()) == "zinc");
+    }
+
+    SUBCASE("Copies and moves keep the lookup consistent with the strings") {
+        static_assert(std::is_nothrow_move_constructible_v<DictionaryContainer>);
+        static_assert(std::is_nothrow_move_assignable_v<DictionaryContainer>);
+
+        DictionaryContainer copy(dictionary);
+        dictionary = DictionaryContainer(); // The copy must not look strings up in the original.
+        copy.addElement("red");
+        CHECK(copy.distinct_count() == 5);
+        copy.removeElement("violet");
+        CHECK(*copy.begin(descending) == "red");
+
+        const std::string* first = &copy.value_of(0);
+        DictionaryContainer moved(std::move(copy));
+        CHECK(&moved.value_of(0) == first); // Strings are not relocated by a move.
+        CHECK(copy.size() == 0);
+        CHECK(copy.distinct_count() == 0);
+        moved.addElement("blue");
+        CHECK(moved.distinct_count() == 5);
+
+        DictionaryContainer assigned;
+        assigned = std::move(moved);
+        assigned.removeElement("blue");
+        CHECK(assigned.size() == plain.size() + 1 - 50 - 100);
+        CHECK(*assigned.begin(ascending) == "amber");
+    }
+}
+
+TEST_CASE("Prefix-key string sorting") {
+    // Strings that share long prefixes, differ only in length or by trailing NULs, use bytes above 0x7f
+    // and repeat, so every branch of the prefix-key path is exercised.
+    std::vector<std::string> values{"", "", std::string(1, '\0'), std::string("ab\0", 3), "ab", "abc",
+                                    "\xff", "\x80z", "zz", std::string(100, 'q'), std::string(100, 'q'),
+                                    std::string(99, 'q'), std::string(100, 'q') + "a"};
+    const std::string shared = "common-prefix-longer-than-eight-bytes/";
+    for (int i = 0; i < 500; ++i) {
+        values.push_back(shared + std::to_string((i * 7919) % 613));
+        values.push_back(std::to_string(i % 37));
+    }
+    MyContainer<std::string> container;
+    container.addElements(values.begin(), values.end());
+
+    std::vector<std::string> expected = values;
+    std::sort(expected.begin(), expected.end());
+    CHECK(std::vector<std::string>(container.begin(ascending), container.end(ascending)) == expected);
+    CHECK(std::vector<std::string>(container.begin(descending), container.end(descending)) ==
+          std::vector<std::string>(expected.rbegin(), expected.rend()));
+
+    auto sorted = container.sorted_indexes();
+    std::vector<size_t> permutation = *sorted;
+    std::sort(permutation.begin(), permutation.end());
+    for (size_t i = 0; i < permutation.size(); ++i) {
+        REQUIRE(permutation[i] == i);
+    }
+
+    SUBCASE("Parallel bulk load sorts its slices the same way") {
+        MyContainer<std::string> loaded;
+        loaded.bulk_load(values, 4);
+        CHECK(std::vector<std::string>(loaded.begin(ascending), loaded.end(ascending)) == expected);
+    }
+
+    SUBCASE("Many copies of a long string") {
+        MyContainer<std::string> repeated;
+        for (int i = 0; i < 50; ++i) {
+            repeated.addElement(std::string(100000, 'x'));
+        }
+        repeated.addElement(std::string(100000, 'x') + "y");
+        repeated.addElement("w");
+        CHECK(*repeated.begin(ascending) == "w");
+        CHECK(*repeated.begin(descending) == std::string(100000, 'x') + "y");
+    }
+}
+
+TEST_CASE("Custom comparator and projection") {
+    struct Person {
+        std::string name;
+        int age;
+    };
+    MyContainer<Person> people;
+    people.addElement({"Dana", 41});
+    people.addElement({"Ari", 29});
+    people.addElement({"Lee", 35});
+    people.addElement({"Bo", 52});
+    auto names = [](auto first, auto last) {
+        std::vector<std::string> result;
+        for (; first != last; ++first) {
+            result.push_back(first->name);
+        }
+        return result;
+    };
+
+    SUBCASE("Member projections sort by one field without wrapper types") {
+        auto by_age = ascending_by(std::ranges::less{}, &Person::age);
+        CHECK(names(people.begin(by_age), people.end(by_age)) == std::vector<std::string>{"Ari", "Lee", "Dana", "Bo"});
+        auto by_name = descending_by({}, &Person::name);
+        CHECK(names(people.begin(by_name), people.end(by_name)) == std::vector<std::string>{"Lee", "Dana", "Bo", "Ari"});
+        CHECK(names(people.begin_side_cross_order(std::ranges::less{}, &Person::age),
+                    people.end_side_cross_order(std::ranges::less{}, &Person::age)) ==
+              std::vector<std::string>{"Ari", "Bo", "Lee", "Dana"});
+        CHECK(people.view(by_age).size() == 4);
+    }
+
+    SUBCASE("Different orders are cached side by side until a modification") {
+        auto by_age = people.sorted_indexes(std::ranges::less{}, &Person::age);
+        auto by_name = people.sorted_indexes(std::ranges::less{}, &Person::name);
+        CHECK(*by_age == std::vector<size_t>{1, 2, 0, 3});
+        CHECK(*by_name == std::vector<size_t>{1, 3, 0, 2});
+        CHECK(people.sorted_indexes(std::ranges::less{}, &Person::age) == by_age);  // Same cached permutation.
+        CHECK(people.sorted_indexes(std::ranges::less{}, &Person::name) == by_name);
+        CHECK(people.sorted_indexes(std::ranges::greater{}, &Person::age) != by_age);
+
+        people.addElement({"Cy", 18});
+        auto updated = people.sorted_indexes(std::ranges::less{}, &Person::age);
+        CHECK(updated != by_age);
+        CHECK(updated->front() == 4);
+        CHECK(*by_age == std::vector<size_t>{1, 2, 0, 3});  // Earlier snapshots are unaffected.
+    }
+
+    SUBCASE("Computed keys are projected once per element") {
+        MyContainer<int> numbers;
+        for (int i = -5; i <= 5; ++i) {
+            numbers.addElement(i);
+        }
+        int projections = 0;
+        auto by_magnitude = ascending_by(std::ranges::less{}, [&projections](int x) {
+            ++projections;
+            return x < 0 ? -x : x;
+        });
+        auto it = numbers.begin(by_magnitude);
+        CHECK(projections == 11);
+        CHECK(*it == 0);
+        std::vector<int> magnitudes;
+        for (; it != numbers.end(by_magnitude); ++it) {
+            magnitudes.push_back(std::abs(*it));
+        }
+        CHECK(std::is_sorted(magnitudes.begin(), magnitudes.end()));
+        for (const std::vector<int>& batch : numbers.stream(by_magnitude, 20)) {
+            CHECK(batch.front() == 0);
+        }
+
+        std::vector<int> descending_values;
+        numbers.parallel_for_each(descending_by(std::ranges::greater{}), [&](int) {}, 0);
+        auto halves = numbers.split(descending_by(std::ranges::greater{}), 2);
+        for (auto x : halves[1]) {
+            descending_values.push_back(x);
+        }
+        CHECK(descending_values == std::vector<int>{0, 1, 2, 3, 4, 5});  // Greater, read back to front.
+    }
+
+    SUBCASE("Projections may query the container they sort") {
+        // Cacheable (equality comparable) projection that ranks each person by age through the same container.
+        struct AgeRank {
+            const MyContainer<Person>* container;
+            bool operator==(const AgeRank&) const = default;
+            size_t operator()(const Person& person) const {
+                auto by_age = container->sorted_indexes(std::ranges::less{}, &Person::age);
+                for (size_t rank = 0; rank < by_age->size(); ++rank) {
+                    if (container->contents()[(*by_age)[rank]].name == person.name) {
+                        return rank;
+                    }
+                }
+                return by_age->size();
+            }
+        };
+        auto by_rank = people.sorted_indexes(std::ranges::greater{}, AgeRank{&people});
+        CHECK(*by_rank == std::vector<size_t>{3, 0, 2, 1});
+        CHECK(people.sorted_indexes(std::ranges::greater{}, AgeRank{&people}) == by_rank);
+    }
+}
+
+TEST_CASE("Stable ordering of equal elements") {
+    // Values whose order ignores the tag, so equal keys are distinguishable after sorting.
+    struct Tagged {
+        int key;
+        int tag;
+        bool operator<(const Tagged& other) const { return key < other.key; }
+    };
+    auto permutation_is_stable = [](const auto& values, const std::vector<size_t>& sorted) {
+        for (size_t i = 1; i < sorted.size(); ++i) {
+            if (!(values[sorted[i - 1]] < values[sorted[i]]) && sorted[i - 1] > sorted[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    SUBCASE("Every element type breaks ties by insertion index") {
+        MyContainer<int> numbers;
+        MyContainer<double> reals;
+        MyContainer<std::string> words;
+        MyContainer<Tagged> tagged;
+        for (int i = 0; i < 3000; ++i) {
+            numbers.addElement((i * 7919) % 50);
+            reals.addElement(((i * 7919) % 50) / 4.0);
+            words.addElement(std::string(i % 3 == 0 ? "a-long-shared-prefix-" : "") + std::to_string((i * 7919) % 50));
+            tagged.addElement({(i * 7919) % 50, i});
+        }
+        CHECK(permutation_is_stable(numbers.getElements(), *numbers.sorted_indexes()));
+        CHECK(permutation_is_stable(reals.getElements(), *reals.sorted_indexes()));
+        CHECK(permutation_is_stable(words.getElements(), *words.sorted_indexes()));
+        CHECK(permutation_is_stable(tagged.getElements(), *tagged.sorted_indexes()));
+
+        // Descending order is the ascending permutation read backwards: ties by decreasing index.
+        std::vector<int> tags;
+        for (auto it = tagged.begin(descending); it != tagged.end(descending) && tags.size() < 3; ++it) {
+            tags.push_back(it->tag);
+        }
+        CHECK(std::is_sorted(tags.rbegin(), tags.rend()));
+
+        auto by_remainder = tagged.sorted_indexes(std::ranges::less{}, [](const Tagged& t) { return t.key % 5; });
+        for (size_t i = 1; i < by_remainder->size(); ++i) {
+            size_t a = (*by_remainder)[i - 1];
+            size_t b = (*by_remainder)[i];
+            if (tagged.getElements()[a].key % 5 == tagged.getElements()[b].key % 5) {
+                REQUIRE(a < b);
+            }
+        }
+    }
+
+    SUBCASE("Bulk loading produces the identical permutation") {
+        std::vector<Tagged> values;
+        for (int i = 0; i < 5000; ++i) {
+            values.push_back({(i * 7919) % 97, i});
+        }
+        MyContainer<Tagged> sorted_once;
+        sorted_once.addElements(values.begin(), values.end());
+        MyContainer<Tagged> loaded;
+        loaded.bulk_load(values, 4);
+        CHECK(*loaded.sorted_indexes() == *sorted_once.sorted_indexes());
+    }
+}
+
+TEST_CASE("Top-k queries") {
+    MyContainer<int> container;
+    for (int i = 0; i < 10000; ++i) {
+        container.addElement((i * 7919) % 1009 - 500);
+    }
+    // Full traversals run on a separate container, so 'container' never caches its permutation.
+    MyContainer<int> reference;
+    reference.addElements(container.getElements().begin(), container.getElements().end());
+    auto prefix = [&](auto order, size_t k) {
+        std::vector<int> result;
+        for (auto it = reference.begin(order); it != reference.end(order) && result.size() < k; ++it) {
+            result.push_back(*it);
+        }
+        return result;
+    };
+
+    SUBCASE("Without a cached permutation nothing is sorted") {
+        CHECK(container.bottom_k(5) == std::vector<int>{-500, -500, -500, -500, -500});
+        CHECK(container.top_k(3) == std::vector<int>{508, 508, 508});
+        CHECK(container.side_cross_prefix(4) == std::vector<int>{-500, 508, -500, 508});
+        CHECK_FALSE(container.has_sorted_indexes());
+
+        for (size_t k : {size_t{0}, size_t{1}, size_t{7}, size_t{100}}) {
+            std::vector<int> bottom = container.bottom_k(k);
+            std::vector<int> top = container.top_k(k);
+            std::vector<int> cross = container.side_cross_prefix(k);
+            CHECK(bottom == prefix(ascending, k));
+            CHECK(top == prefix(descending, k));
+            CHECK(cross == prefix(side_cross, k));
+        }
+        CHECK_FALSE(container.has_sorted_indexes());
+    }
+
+    SUBCASE("More than size() returns every element in order") {
+        MyContainer<int> small;
+        for (int v : {3, 1, 2}) {
+            small.addElement(v);
+        }
+        CHECK(small.bottom_k(10) == std::vector<int>{1, 2, 3});
+        CHECK(small.top_k(10) == std::vector<int>{3, 2, 1});
+        CHECK(small.side_cross_prefix(10) == std::vector<int>{1, 3, 2});
+        CHECK(MyContainer<int>().top_k(3).empty());
+    }
+
+    SUBCASE("Ties match the full traversals") {
+        struct Tagged {
+            int key;
+            int tag;
+            bool operator<(const Tagged& other) const { return key < other.key; }
+        };
+        MyContainer<Tagged> tagged;
+        for (int i = 0; i < 50; ++i) {
+            tagged.addElement({i % 3, i});
+        }
+        auto tags = [](const std::vector<Tagged>& values) {
+            std::vector<int> result;
+            for (const Tagged& t : values) {
+                result.push_back(t.tag);
+            }
+            return result;
+        };
+        CHECK(tags(tagged.bottom_k(3)) == std::vector<int>{0, 3, 6});
+        CHECK(tags(tagged.top_k(3)) == std::vector<int>{47, 44, 41});
+        CHECK(tags(tagged.side_cross_prefix(4)) == std::vector<int>{0, 47, 3, 44});
+        tagged.sorted_indexes();
+        CHECK(tags(tagged.top_k(3)) == std::vector<int>{47, 44, 41});
+        CHECK(tags(tagged.side_cross_prefix(4)) == std::vector<int>{0, 47, 3, 44});
+    }
+}
+
+TEST_CASE("Distinct values and frequencies") {
+    MyContainer<int> container;
+    for (int i = 0; i < 1000; ++i) {
+        container.addElement((i * 7919) % 7 == 0 ? 42 : (i * 31) % 13);
+    }
+    std::map<int, size_t> expected;
+    for (int value : container.getElements()) {
+        ++expected[value];
+    }
+
+    SUBCASE("Runs of the sorted permutation") {
+        std::vector<int> distinct;
+        for (int value : container.distinct_ascending()) {
+            distinct.push_back(value);
+        }
+        std::vector<int> keys;
+        for (const auto& entry : expected) {
+            keys.push_back(entry.first);
+        }
+        CHECK(distinct == keys);
+
+        std::vector<std::pair<int, size_t>> counts;
+        for (auto [value, count] : container.frequencies()) {
+            counts.emplace_back(value, count);
+        }
+        CHECK(counts == std::vector<std::pair<int, size_t>>(expected.begin(), expected.end()));
+        CHECK(std::ranges::distance(container.distinct_ascending()) == 14);
+    }
+
+    SUBCASE("Edge cases") {
+        MyContainer<int> empty;
+        CHECK(empty.distinct_ascending().begin() == std::default_sentinel);
+        CHECK(std::ranges::distance(empty.frequencies()) == 0);
+
+        MyContainer<int> same;
+        for (int i = 0; i < 1000; ++i) {
+            same.addElement(7);
+        }
+        auto only = same.frequencies().begin();
+        CHECK((*only).value == 7);
+        CHECK((*only).count == 1000);
+        CHECK(++only == std::default_sentinel);
+    }
+
+    SUBCASE("Each run exposes its earliest element") {
+        MyContainer<std::string> words;
+        for (const char* word : {"pear", "fig", "pear", "apple", "fig", "fig"}) {
+            words.addElement(word);
+        }
+        auto frequencies = words.frequencies();
+        auto it = frequencies.begin();
+        CHECK(&(*it).value == &words.getElements()[3]);
+        ++it;
+        CHECK(&(*it).value == &words.getElements()[1]);
+        CHECK((*it).count == 3);
+    }
+
+    SUBCASE("Both are forward ranges and compose with views") {
+        static_assert(std::ranges::forward_range<decltype(container.distinct_ascending())>);
+        static_assert(std::ranges::forward_range<decltype(container.frequencies())>);
+
+        std::vector<int> smallest;
+        for (int value : container.distinct_ascending() | std::views::take(3)) {
+            smallest.push_back(value);
+        }
+        CHECK(smallest == std::vector<int>{0, 1, 2});
+
+        auto common = container.frequencies() |
+                      std::views::filter([](const auto& run) { return run.count > 100; }) |
+                      std::views::transform([](const auto& run) { return run.value; });
+        std::vector<int> frequent;
+        for (int value : common) {
+            frequent.push_back(value);
+        }
+        std::vector<int> expected_frequent;
+        for (const auto& [value, count] : expected) {
+            if (count > 100) {
+                expected_frequent.push_back(value);
+            }
+        }
+        CHECK(frequent == expected_frequent);
+        CHECK_FALSE(expected_frequent.empty());
+    }
+
+    SUBCASE("Hash-based distinct keeps first-appearance order") {
+        std::vector<int> distinct = container.distinct_unordered();
+        CHECK(distinct.size() == expected.size());
+        CHECK(distinct.front() == container.getElements().front());
+        std::vector<int> first_seen;
+        for (int value : container.getElements()) {
+            if (std::find(first_seen.begin(), first_seen.end(), value) == first_seen.end()) {
+                first_seen.push_back(value);
+            }
+        }
+        CHECK(distinct == first_seen);
+        CHECK_FALSE(container.has_sorted_indexes());
+    }
+}
@@ -0,0 +1,50 @@
+// Unit tests of the unchecked (release) iterator mode; built by `make test_unchecked` with
+// MYCONTAINER_CHECKED_ITERATORS=0, -O2 and NDEBUG. Test.cpp covers the checked mode.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <vector>
+#include <utility>
+#include "MyContainer.hpp"
+
+using namespace Container;
+
+static_assert(!checked_iterators, "UncheckedTest.cpp must be built with MYCONTAINER_CHECKED_ITERATORS=0.");
+
+TEST_CASE("Unchecked iterators") {
+    MyContainer<int> container;
+    for (int value : {7, 15, 6, 1, 2}) {
+        container.addElement(value);
+    }
+
+    SUBCASE("operator* is noexcept") {
+        CHECK(noexcept(*std::declval<const MyContainer<int>::OrderIterator&>()));
+        CHECK(noexcept(*std::declval<const MyContainer<int>::AscendingOrderIterator&>()));
+        CHECK(noexcept(*std::declval<const MyContainer<int>::DescendingOrderIterator&>()));
+        CHECK(noexcept(*std::declval<const MyContainer<int>::ReverseOrderIterator&>()));
+        CHECK(noexcept(*std::declval<const MyContainer<int>::SideCrossOrderIterator&>()));
+        CHECK(noexcept(*std::declval<const MyContainer<int>::MiddleOutOrderIterator&>()));
+    }
+
+    SUBCASE("Every order traverses the same elements as in checked builds") {
+        auto collect = [&](auto order) {
+            return std::vector<int>(container.begin(order), container.end(order));
+        };
+        CHECK(collect(insertion) == std::vector<int>{7, 15, 6, 1, 2});
+        CHECK(collect(ascending) == std::vector<int>{1, 2, 6, 7, 15});
+        CHECK(collect(descending) == std::vector<int>{15, 7, 6, 2, 1});
+        CHECK(collect(reverse) == std::vector<int>{2, 1, 6, 15, 7});
+        CHECK(collect(side_cross) == std::vector<int>{1, 15, 2, 7, 6});
+        CHECK(collect(middle_out) == std::vector<int>{6, 15, 1, 7, 2});
+    }
+
+    SUBCASE("Traversal after modifications") {
+        container.removeElement(15);
+        container.addElement(3);
+        long long sum = 0;
+        for (int value : container) {
+            sum += value;
+        }
+        CHECK(sum == 19);
+        CHECK(*container.begin(descending) == 7);
+    }
+}
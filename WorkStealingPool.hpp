@@ -0,0 +1,211 @@
+//WorkStealingPool.hpp
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+namespace Container {
+    // --- WorkStealingPool (reusable thread pool for MyContainer::parallel_for_each)
+    // A fixed set of worker threads, each with its own task deque. A worker runs its own tasks newest
+    // first and, when it runs dry, steals the oldest task of another worker, so chunks of unequal cost
+    // still keep every thread busy. The threads are started once and reused by every call until the pool
+    // is destroyed; shared() is a process-wide default pool. The thread that calls parallel_for runs
+    // tasks too while it waits, so a pool with no workers still works (sequentially).
+    class WorkStealingPool {
+    private:
+        struct TaskQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<TaskQueue>> queues;  // One per worker.
+        std::vector<std::thread> workers;
+
+        // Idle workers sleep on 'wake'. 'queued' counts the tasks in the queues, plus those about to be
+        // pushed: it grows under 'sleep_mutex' before the tasks are pushed, so no wake-up is lost and a
+        // task is always counted before a worker can take it (the counter never wraps below zero).
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+        std::atomic<size_t> queued{0};
+        bool stopping = false;
+
+        // Spreads calling threads over the queues they start looking at.
+        std::atomic<size_t> next_home{0};
+
+        // Runs one task: the newest of queue 'home' or else the oldest of any other queue.
+        bool try_run_one(size_t home) {
+            for (size_t i = 0; i < queues.size(); ++i) {
+                TaskQueue& queue = *queues[(home + i) % queues.size()];
+                std::function<void()> task;
+                {
+                    std::lock_guard<std::mutex> lock(queue.mutex);
+                    if (queue.tasks.empty()) {
+                        continue;
+                    }
+                    if (i == 0) {
+                        task = std::move(queue.tasks.back());
+                        queue.tasks.pop_back();
+                    } else {
+                        task = std::move(queue.tasks.front());
+                        queue.tasks.pop_front();
+                    }
+                }
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                task();
+                return true;
+            }
+            return false;
+        }
+
+        void worker_loop(size_t home) {
+            for (;;) {
+                if (try_run_one(home)) {
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                wake.wait(lock, [&] { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+                if (stopping && queued.load(std::memory_order_relaxed) == 0) {
+                    return;
+                }
+            }
+        }
+
+    public:
+        // One worker fewer than the hardware threads, since the calling thread works as well.
+        static size_t default_worker_count() {
+            size_t hardware = std::thread::hardware_concurrency();
+            return hardware > 1 ? hardware - 1 : 0;
+        }
+
+        explicit WorkStealingPool(size_t worker_count = default_worker_count()) {
+            for (size_t i = 0; i < worker_count; ++i) {
+                queues.push_back(std::make_unique<TaskQueue>());
+            }
+            for (size_t i = 0; i < worker_count; ++i) {
+                workers.emplace_back([this, i] { worker_loop(i); });
+            }
+        }
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        // Finishes the queued tasks, then joins the workers.
+        ~WorkStealingPool() {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        // The process-wide pool used when no pool is passed explicitly.
+        static WorkStealingPool& shared() {
+            static WorkStealingPool pool;
+            return pool;
+        }
+
+        size_t worker_count() const noexcept {
+            return workers.size();
+        }
+
+        // Calls body(first, last) for consecutive chunks [first, last) of [0, count), each at most 'grain'
+        // long (0 picks a grain that gives every thread a few chunks), and returns once all chunks are done.
+        // Chunks run concurrently and in no particular order. If a chunk throws, chunks that have not
+        // started yet are skipped and the first exception is rethrown here.
+        template <typename Body>
+        void parallel_for(size_t count, size_t grain, Body&& body) {
+            if (count == 0) {
+                return;
+            }
+            if (grain == 0) {
+                grain = std::max<size_t>(1, count / ((workers.size() + 1) * 4));
+            }
+            const size_t chunks = (count + grain - 1) / grain;
+            if (chunks == 1 || workers.empty()) {
+                body(size_t{0}, count);
+                return;
+            }
+
+            struct Batch {
+                std::atomic<size_t> remaining{0};
+                std::atomic<bool> failed{false};
+                std::exception_ptr error;
+                std::mutex mutex;  // Guards 'error' and the 'done' wait.
+                std::condition_variable done;
+            };
+            auto batch = std::make_shared<Batch>();
+            batch->remaining.store(chunks, std::memory_order_relaxed);
+
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                queued.fetch_add(chunks, std::memory_order_relaxed);
+            }
+
+            // Neighbouring chunks start on the same worker; idle workers steal the rest. If a push fails,
+            // the chunks not pushed are uncounted and the failure is reported like a failed chunk, once
+            // the pushed ones are done.
+            size_t pushed = 0;
+            try {
+                for (size_t w = 0; w < queues.size(); ++w) {
+                    size_t chunk_begin = chunks * w / queues.size();
+                    size_t chunk_end = chunks * (w + 1) / queues.size();
+                    std::lock_guard<std::mutex> lock(queues[w]->mutex);
+                    for (size_t chunk = chunk_begin; chunk < chunk_end; ++chunk, ++pushed) {
+                        size_t first = chunk * grain;
+                        size_t last = std::min(count, first + grain);
+                        queues[w]->tasks.push_back([batch, &body, first, last] {
+                            if (!batch->failed.load(std::memory_order_relaxed)) {
+                                try {
+                                    body(first, last);
+                                } catch (...) {
+                                    std::lock_guard<std::mutex> error_lock(batch->mutex);
+                                    if (!batch->error) {
+                                        batch->error = std::current_exception();
+                                    }
+                                    batch->failed.store(true, std::memory_order_relaxed);
+                                }
+                            }
+                            if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                                std::lock_guard<std::mutex> done_lock(batch->mutex);
+                                batch->done.notify_all();
+                            }
+                        });
+                    }
+                }
+            } catch (...) {
+                const size_t unpushed = chunks - pushed;
+                queued.fetch_sub(unpushed, std::memory_order_relaxed);
+                {
+                    std::lock_guard<std::mutex> error_lock(batch->mutex);
+                    if (!batch->error) {
+                        batch->error = std::current_exception();
+                    }
+                }
+                batch->failed.store(true, std::memory_order_relaxed);
+                batch->remaining.fetch_sub(unpushed, std::memory_order_acq_rel);
+            }
+            wake.notify_all();
+
+            // Help until nothing is left to take, then wait for the chunks still running elsewhere.
+            const size_t home = next_home.fetch_add(1, std::memory_order_relaxed) % queues.size();
+            while (batch->remaining.load(std::memory_order_acquire) != 0 && try_run_one(home)) {
+            }
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->done.wait(lock, [&] { return batch->remaining.load(std::memory_order_acquire) == 0; });
+            if (batch->error) {
+                std::rethrow_exception(batch->error);
+            }
+        }
+    };
+}